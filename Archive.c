@@ -0,0 +1,182 @@
+//////////////////////////////////////////////////////////////////////
+// LICENSE
+//////////////////////////////////////////////////////////////////////
+
+// MIT License
+
+// Copyright (c) 2021 Klayton Kowalski
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// https://github.com/klaytonkowalski/game-fruit-ninja
+
+
+//////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////
+
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "Archive.h"
+#include "Binary.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////
+
+static bool MapArchive(Archive *archive, const char *path);
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTIONS
+//////////////////////////////////////////////////////////////////////
+
+// Maps the whole file and checks that the header and every index entry lie
+// inside it, so lookups can trust the index afterwards.
+bool OpenArchive(Archive *archive, const char *path)
+{
+    *archive = (Archive) { 0 };
+    if (!MapArchive(archive, path))
+    {
+        return false;
+    }
+    bool valid = archive->size >= ARCHIVE_HEADER_SIZE &&
+        memcmp(archive->data, "FNPK", 4) == 0 &&
+        DecodeInteger(archive->data + 4, 4) == ARCHIVE_VERSION;
+    if (valid)
+    {
+        const uint64_t entryCount = DecodeInteger(archive->data + 8, 4);
+        valid = entryCount <= (archive->size - ARCHIVE_HEADER_SIZE) / ARCHIVE_ENTRY_SIZE;
+        for (uint64_t i = 0; valid && i < entryCount; ++i)
+        {
+            const unsigned char *entry = archive->data + ARCHIVE_HEADER_SIZE + i * ARCHIVE_ENTRY_SIZE;
+            const uint64_t offset = DecodeInteger(entry + ARCHIVE_NAME_SIZE, 8);
+            const uint64_t size = DecodeInteger(entry + ARCHIVE_NAME_SIZE + 8, 8);
+            valid = offset <= archive->size && size <= archive->size - offset && size <= INT32_MAX;
+        }
+        archive->entryCount = entryCount;
+    }
+    if (!valid)
+    {
+        CloseArchive(archive);
+    }
+    return valid;
+}
+
+// Returns the entry's bytes inside the mapping, or NULL when there is no entry
+// with that name. The bytes stay valid until the archive is closed.
+const unsigned char *FindArchiveEntry(const Archive *archive, const char *name, int *size)
+{
+    for (int i = 0; i < archive->entryCount; ++i)
+    {
+        const unsigned char *entry = archive->data + ARCHIVE_HEADER_SIZE + i * ARCHIVE_ENTRY_SIZE;
+        if (strncmp((const char *)entry, name, ARCHIVE_NAME_SIZE) == 0)
+        {
+            *size = DecodeInteger(entry + ARCHIVE_NAME_SIZE + 8, 8);
+            return archive->data + DecodeInteger(entry + ARCHIVE_NAME_SIZE, 8);
+        }
+    }
+    return NULL;
+}
+
+void CloseArchive(Archive *archive)
+{
+#if defined(_WIN32)
+    if (archive->data != NULL)
+    {
+        UnmapViewOfFile(archive->data);
+    }
+    if (archive->mapping != NULL)
+    {
+        CloseHandle(archive->mapping);
+    }
+    if (archive->file != NULL)
+    {
+        CloseHandle(archive->file);
+    }
+#else
+    if (archive->data != NULL)
+    {
+        munmap((void *)archive->data, archive->size);
+    }
+#endif
+    *archive = (Archive) { 0 };
+}
+
+static bool MapArchive(Archive *archive, const char *path)
+{
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    archive->file = file;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseArchive(archive);
+        return false;
+    }
+    archive->size = size.QuadPart;
+    archive->mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (archive->mapping != NULL)
+    {
+        archive->data = MapViewOfFile(archive->mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+#else
+    const int file = open(path, O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+    struct stat status;
+    if (fstat(file, &status) == 0 && status.st_size > 0)
+    {
+        void *data = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (data != MAP_FAILED)
+        {
+            archive->data = data;
+            archive->size = status.st_size;
+        }
+    }
+    // The mapping keeps its own reference to the file.
+    close(file);
+#endif
+    if (archive->data == NULL)
+    {
+        CloseArchive(archive);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,84 @@
+//////////////////////////////////////////////////////////////////////
+// LICENSE
+//////////////////////////////////////////////////////////////////////
+
+// MIT License
+
+// Copyright (c) 2021 Klayton Kowalski
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// https://github.com/klaytonkowalski/game-fruit-ninja
+
+
+// Read-only access to a packed asset archive, memory mapped so that entries are
+// decoded straight from the page cache without being read into buffers first.
+// Archives are written by the Pack tool.
+//
+// Archive layout, all little-endian:
+//   header  "FNPK", version u32, entry count u32, reserved u32
+//   index   per entry: name (ARCHIVE_NAME_SIZE bytes, zero padded), offset u64,
+//           size u64
+//   data    entries back to back, each starting on an ARCHIVE_ALIGNMENT
+//           boundary
+
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+//////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////
+
+#include <stdbool.h>
+#include <stddef.h>
+
+//////////////////////////////////////////////////////////////////////
+// DEFINES
+//////////////////////////////////////////////////////////////////////
+
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_HEADER_SIZE 16
+#define ARCHIVE_NAME_SIZE 48
+#define ARCHIVE_ENTRY_SIZE (ARCHIVE_NAME_SIZE + 16)
+#define ARCHIVE_ALIGNMENT 16
+
+//////////////////////////////////////////////////////////////////////
+// STRUCTURES
+//////////////////////////////////////////////////////////////////////
+
+// The file and mapping handles are only used on Windows.
+typedef struct Archive
+{
+    const unsigned char *data;
+    size_t size;
+    int entryCount;
+    void *file;
+    void *mapping;
+}
+Archive;
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////
+
+bool OpenArchive(Archive *archive, const char *path);
+const unsigned char *FindArchiveEntry(const Archive *archive, const char *name, int *size);
+void CloseArchive(Archive *archive);
+
+#endif
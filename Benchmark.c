@@ -0,0 +1,254 @@
+//////////////////////////////////////////////////////////////////////
+// LICENSE
+//////////////////////////////////////////////////////////////////////
+
+// MIT License
+
+// Copyright (c) 2021 Klayton Kowalski
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// https://github.com/klaytonkowalski/game-fruit-ninja
+
+
+// Measures the simulation at fixed fruit counts and prints the results as JSON,
+// so runs can be diffed across commits. Each run tops the store up to its fruit
+// count every frame and holds a slash along the scripted headless player's path
+// the whole time, so spawning, integration, the slash query, particle expiry and
+// effects run on every tick. Lethal fruit are given no spawn weight, so rounds
+// are not lost to the first donut in a crowded store. The trail's short
+// lifetime keeps it to a dozen or so particles whatever the fruit count, so only
+// the fruit count is varied. The seed defaults to a fixed value so that runs
+// from different commits compare.
+//
+// Usage: Benchmark [--seconds <seconds>] [--fruit-counts <count,...>]
+//                  [--output <path>] [simulation options]
+
+//////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////
+
+#include "Headless.h"
+#include "Profiler.h"
+#include "Simulation.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//////////////////////////////////////////////////////////////////////
+// DEFINES
+//////////////////////////////////////////////////////////////////////
+
+#define MAXIMUM_RUN_COUNT 32
+
+//////////////////////////////////////////////////////////////////////
+// STRUCTURES
+//////////////////////////////////////////////////////////////////////
+
+typedef struct BenchmarkResult
+{
+    int fruitCount;
+    unsigned long long ticks;
+    unsigned long long fruitTicks;
+    unsigned long long allocations;
+    int rounds;
+    double seconds;
+}
+BenchmarkResult;
+
+//////////////////////////////////////////////////////////////////////
+// CONSTANTS
+//////////////////////////////////////////////////////////////////////
+
+static const float defaultBenchmarkSeconds = 5;
+static const unsigned long long defaultBenchmarkSeed = 1;
+static const int defaultFruitCounts[] = { 48, 256, 1024, 4096, 16384, 65536, 262144, 1048576 };
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////
+
+static bool RunBenchmark(int fruitCount, float seconds, BenchmarkResult *result);
+static void StartRound(int frame);
+static void DisableLethalFruit();
+static void WriteResults(FILE *file, const BenchmarkResult results[], int resultCount, float seconds);
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTIONS
+//////////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[])
+{
+    ConfigureSimulation(argc, argv);
+    bool seeded = false;
+    float seconds = defaultBenchmarkSeconds;
+    int fruitCounts[MAXIMUM_RUN_COUNT];
+    int runCount = sizeof(defaultFruitCounts) / sizeof(defaultFruitCounts[0]);
+    memcpy(fruitCounts, defaultFruitCounts, sizeof(defaultFruitCounts));
+    const char *outputPath = NULL;
+    for (int i = 1; i < argc - 1; ++i)
+    {
+        if (strcmp(argv[i], "--seconds") == 0)
+        {
+            seconds = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--fruit-counts") == 0)
+        {
+            runCount = 0;
+            for (char *count = argv[++i]; *count != '\0' && runCount < MAXIMUM_RUN_COUNT; ++count)
+            {
+                fruitCounts[runCount++] = strtol(count, &count, 10);
+                if (*count == '\0')
+                {
+                    break;
+                }
+            }
+        }
+        else if (strcmp(argv[i], "--output") == 0)
+        {
+            outputPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--seed") == 0)
+        {
+            seeded = true;
+            ++i;
+        }
+    }
+    // ConfigureSimulation applies --seed; without it runs use a fixed seed
+    // instead of the time, so results compare across commits.
+    if (!seeded)
+    {
+        simulationSeed = defaultBenchmarkSeed;
+    }
+    BenchmarkResult results[MAXIMUM_RUN_COUNT];
+    for (int i = 0; i < runCount; ++i)
+    {
+        if (!RunBenchmark(fruitCounts[i], seconds, &results[i]))
+        {
+            fprintf(stderr, "%d fruit: cannot allocate the simulation\n", fruitCounts[i]);
+            return 1;
+        }
+        fprintf(stderr, "%d fruit: %.1f ns per fruit per tick\n", results[i].fruitCount, results[i].fruitTicks > 0 ? results[i].seconds * 1e9 / results[i].fruitTicks : 0.0);
+    }
+    FILE *file = outputPath != NULL ? fopen(outputPath, "w") : stdout;
+    if (file == NULL)
+    {
+        fprintf(stderr, "%s: cannot write results\n", outputPath);
+        return 1;
+    }
+    WriteResults(file, results, runCount, seconds);
+    if (file != stdout)
+    {
+        fclose(file);
+    }
+    return 0;
+}
+
+// Every run starts from a fresh simulation with the same seed. Filling the
+// store happens before the clock starts; topping it up is part of the run.
+// Returns false when the simulation does not fit in memory.
+static bool RunBenchmark(int fruitCount, float seconds, BenchmarkResult *result)
+{
+    *result = (BenchmarkResult) { 0 };
+    result->fruitCount = fruitCount;
+    fruits.capacity = fruitCount;
+    if (!InitializeSimulation())
+    {
+        return false;
+    }
+    const int frameCount = seconds * targetFPS;
+    const float frameTime = 1.0 / targetFPS;
+    DisableLethalFruit();
+    StartRound(0);
+    SpawnFruits(fruitCount);
+    const unsigned long long startAllocations = simulationAllocations;
+    const unsigned long long startTicks = simulationTicks;
+    const double startTime = GetProfileTime();
+    bool pressed = false;
+    for (int frame = 1; frame <= frameCount; ++frame)
+    {
+        if (state != playState)
+        {
+            StartRound(frame);
+            ++result->rounds;
+            pressed = false;
+        }
+        SpawnFruits(fruitCount - fruits.count);
+        const unsigned long long frameTicks = simulationTicks;
+        const int frameFruit = fruits.count;
+        // Press once and never release, so the slash query runs on every tick
+        // along the scripted path.
+        const SimulationInput input = { GetSyntheticInput(frame).pointer, !pressed, false };
+        pressed = true;
+        UpdateSimulation(input, frameTime);
+        result->fruitTicks += (unsigned long long)frameFruit * (simulationTicks - frameTicks);
+    }
+    result->seconds = GetProfileTime() - startTime;
+    result->ticks = simulationTicks - startTicks;
+    result->allocations = simulationAllocations - startAllocations;
+    TerminateSimulation();
+    return true;
+}
+
+// Presses through the lose and start screens into play.
+static void StartRound(int frame)
+{
+    while (state != playState)
+    {
+        UpdateSimulation((SimulationInput) { GetSyntheticInput(frame).pointer, true, false }, 1.0 / targetFPS);
+    }
+}
+
+// Only the benchmark's own simulation is changed. InitializeSimulation restores
+// the descriptor weights.
+static void DisableLethalFruit()
+{
+    int weights[fruitTypeCount];
+    for (int i = 0; i < fruitTypeCount; ++i)
+    {
+        weights[i] = fruitDescriptors[i].lethal ? 0 : fruitDescriptors[i].spawnWeight;
+    }
+    SetFruitSpawnWeights(weights);
+}
+
+static void WriteResults(FILE *file, const BenchmarkResult results[], int resultCount, float seconds)
+{
+    fprintf(file, "{\n");
+    fprintf(file, "  \"seed\": %llu,\n", simulationSeed);
+    fprintf(file, "  \"simulatedSeconds\": %g,\n", seconds);
+    fprintf(file, "  \"simulationRate\": %d,\n", simulationRate);
+    fprintf(file, "  \"runs\": [\n");
+    for (int i = 0; i < resultCount; ++i)
+    {
+        const BenchmarkResult result = results[i];
+        fprintf(file, "    {\n");
+        fprintf(file, "      \"fruitCount\": %d,\n", result.fruitCount);
+        fprintf(file, "      \"ticks\": %llu,\n", result.ticks);
+        fprintf(file, "      \"averageFruit\": %.1f,\n", result.ticks > 0 ? (double)result.fruitTicks / result.ticks : 0.0);
+        fprintf(file, "      \"rounds\": %d,\n", result.rounds);
+        fprintf(file, "      \"seconds\": %.6f,\n", result.seconds);
+        fprintf(file, "      \"nsPerFruitTick\": %.3f,\n", result.fruitTicks > 0 ? result.seconds * 1e9 / result.fruitTicks : 0.0);
+        fprintf(file, "      \"ticksPerSecond\": %.1f,\n", result.seconds > 0 ? result.ticks / result.seconds : 0.0);
+        fprintf(file, "      \"allocations\": %llu\n", result.allocations);
+        fprintf(file, i < resultCount - 1 ? "    },\n" : "    }\n");
+    }
+    fprintf(file, "  ]\n");
+    fprintf(file, "}\n");
+}
@@ -0,0 +1,83 @@
+//////////////////////////////////////////////////////////////////////
+// LICENSE
+//////////////////////////////////////////////////////////////////////
+
+// MIT License
+
+// Copyright (c) 2021 Klayton Kowalski
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// https://github.com/klaytonkowalski/game-fruit-ninja
+
+
+//////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////
+
+#include "Binary.h"
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTIONS
+//////////////////////////////////////////////////////////////////////
+
+// Continues an FNV-1a hash, which starts from HASH_OFFSET_BASIS.
+uint64_t HashBytes(uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+void WriteInteger(FILE *file, uint64_t value, int byteCount)
+{
+    for (int i = 0; i < byteCount; ++i)
+    {
+        fputc((value >> (i * 8)) & 0xFF, file);
+    }
+}
+
+bool ReadInteger(FILE *file, uint64_t *value, int byteCount)
+{
+    *value = 0;
+    for (int i = 0; i < byteCount; ++i)
+    {
+        const int byte = fgetc(file);
+        if (byte == EOF)
+        {
+            return false;
+        }
+        *value |= (uint64_t)byte << (i * 8);
+    }
+    return true;
+}
+
+// Reads an integer from memory, such as a mapped archive.
+uint64_t DecodeInteger(const unsigned char *bytes, int byteCount)
+{
+    uint64_t value = 0;
+    for (int i = byteCount - 1; i >= 0; --i)
+    {
+        value = value << 8 | bytes[i];
+    }
+    return value;
+}
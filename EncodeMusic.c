@@ -0,0 +1,72 @@
+//////////////////////////////////////////////////////////////////////
+// LICENSE
+//////////////////////////////////////////////////////////////////////
+
+// MIT License
+
+// Copyright (c) 2021 Klayton Kowalski
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// https://github.com/klaytonkowalski/game-fruit-ninja
+
+
+// Encodes a wave file as QOA for the asset archive, which holds roughly a fifth
+// of the bytes of 16-bit PCM and decodes cheaply while streaming.
+//
+// Usage: EncodeMusic <input> <output.qoa>
+
+//////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////
+
+#include "raylib.h"
+
+#include <stdio.h>
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTIONS
+//////////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        printf("usage: %s <input> <output.qoa>\n", argv[0]);
+        return 1;
+    }
+    SetTraceLogLevel(LOG_WARNING);
+    Wave wave = LoadWave(argv[1]);
+    if (wave.data == NULL)
+    {
+        printf("%s: cannot load\n", argv[1]);
+        return 1;
+    }
+    // raylib only writes QOA from 16-bit samples.
+    WaveFormat(&wave, wave.sampleRate, 16, wave.channels);
+    const bool exported = ExportWave(wave, argv[2]);
+    UnloadWave(wave);
+    if (!exported)
+    {
+        printf("%s: cannot write\n", argv[2]);
+        return 1;
+    }
+    printf("%s: %d bytes from %d\n", argv[2], GetFileLength(argv[2]), GetFileLength(argv[1]));
+    return 0;
+}
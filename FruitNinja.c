@@ -26,140 +26,199 @@
 
 // https://github.com/klaytonkowalski/game-fruit-ninja
 
+
 //////////////////////////////////////////////////////////////////////
 // INCLUDES
 //////////////////////////////////////////////////////////////////////
 
 #include "raylib.h"
-
+#include "rlgl.h"
+#include "Simulation.h"
+#include "Archive.h"
+#include "Headless.h"
+#include "Profiler.h"
+#include "Replay.h"
+#include "TextureCache.h"
+#include "Thread.h"
+
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 //////////////////////////////////////////////////////////////////////
 // DEFINES
 //////////////////////////////////////////////////////////////////////
 
-#define MAX_FRUIT_COUNT 48
-#define MAX_PARTICLE_COUNT 16
+#define MAXIMUM_VOICE_COUNT 8
 
 //////////////////////////////////////////////////////////////////////
 // ENUMERATIONS
 //////////////////////////////////////////////////////////////////////
 
-typedef enum GameState
+// Images come first, with one per fruit in FruitType order, followed by the
+// sounds.
+typedef enum Asset
 {
-    startState,
-    playState,
-    loseState
+    backgroundAsset,
+    firstFruitAsset,
+    fruitSpawnAsset = firstFruitAsset + fruitTypeCount,
+    fruitSlashAsset,
+    donutSlashAsset,
+    assetCount
 }
-GameState;
+Asset;
 
-typedef enum FruitType
+// In the same order as the sound assets.
+typedef enum SoundEffect
 {
-    appleType,
-    bananaType,
-    cherryType,
-    donutType
+    fruitSpawnSound,
+    fruitSlashSound,
+    donutSlashSound,
+    soundEffectCount
 }
-FruitType;
+SoundEffect;
 
 //////////////////////////////////////////////////////////////////////
 // STRUCTURES
 //////////////////////////////////////////////////////////////////////
 
-typedef struct Fruit
+// Voices are aliases of one loaded sound, sharing its sample data, so the same
+// sound can overlap itself. All of them are made at load time. playOrder holds
+// when each voice last started, for stealing the oldest.
+typedef struct VoicePool
+{
+    Sound voices[MAXIMUM_VOICE_COUNT];
+    unsigned int playOrder[MAXIMUM_VOICE_COUNT];
+    unsigned int playCount;
+    int count;
+}
+VoicePool;
+
+// Assets are decoded into CPU memory on a worker thread, in Asset order, and
+// uploaded by the main thread once decodedCount passes them. Only decodedCount
+// is shared, under the mutex.
+typedef struct AssetLoader
+{
+    Image images[fruitSpawnAsset];
+    Wave waves[assetCount - fruitSpawnAsset];
+    int decodedCount;
+    int uploadedCount;
+    Mutex mutex;
+    Thread thread;
+}
+AssetLoader;
+
+// How the front end shows and plays a fruit type, alongside the simulation's
+// FruitDescriptor.
+typedef struct FruitAppearance
 {
-    FruitType type;
-    Vector2 position;
-    Vector2 velocity;
-    bool enabled;
+    const char *spritePath;
+    Color juiceColor;
+    SoundEffect slashSound;
 }
-Fruit;
+FruitAppearance;
 
-typedef struct Particle
+// Fruit positions for one frame, bucketed by type with a counting sort so that
+// each fruit texture is bound once per frame however the fruit are interleaved
+// in the store.
+typedef struct RenderQueue
 {
-    Vector2 position;
-    float elapsed;
-    bool enabled;
+    float *x;
+    float *y;
+    int bucketStart[fruitTypeCount + 1];
+    int capacity;
 }
-Particle;
+RenderQueue;
 
 //////////////////////////////////////////////////////////////////////
 // CONSTANTS
 //////////////////////////////////////////////////////////////////////
 
-static const int screenWidth = 960;
 static const int screenHalfWidth = screenWidth * 0.5;
-static const int screenHeight = 540;
-static const int targetFPS = 60;
-static const int appleScore = 1;
-static const int bananaScore = appleScore * 3;
-static const int cherryScore = bananaScore * 3;
 static const int largeTextSize = 40;
 static const int normalTextSize = largeTextSize * 0.5;
-static const int fruitRadius = 32;
-static const int appleSpawnCeiling = 50;
-static const int bananaSpawnCeiling = 75;
-static const int cherrySpawnCeiling = 85;
-static const int donutSpawnCeiling = 100;
 static const int mouseRadius = 8;
-static const float minimumFruitThrust = 5;
-static const float maximumFruitThrust = 20;
-static const float minimumFruitStrafe = -5;
-static const float maximumFruitStrafe = 5;
-static const float minimumSpawnRate = 1;
-static const float maximumSpawnRate = 0.1;
-static const float maximumElapsed = 30;
-static const float gravity = -10.0 / targetFPS;
-static const float particleMaximumElapsed = 0.1;
+static const int profileTextSize = 10;
+static const char *backgroundPath = "Background.png";
+static const char *soundPaths[soundEffectCount] = { "FruitSpawn.wav", "FruitSlash.wav", "DonutSlash.wav" };
+static const int voiceLimits[soundEffectCount] = { 2, 6, 1 };
+static const char *musicPaths[] = { "Music.qoa", "Music.ogg", "Music.wav" };
+static const int musicUpdateInterval = 10;
+static const float juiceRadius = 3;
+static const FruitAppearance fruitAppearances[fruitTypeCount] =
+{
+    [appleType] = { .spritePath = "Apple.png", .juiceColor = { 230, 41, 55, 255 }, .slashSound = fruitSlashSound },
+    [bananaType] = { .spritePath = "Banana.png", .juiceColor = { 253, 249, 0, 255 }, .slashSound = fruitSlashSound },
+    [cherryType] = { .spritePath = "Cherry.png", .juiceColor = { 190, 33, 55, 255 }, .slashSound = fruitSlashSound },
+    [donutType] = { .spritePath = "Donut.png", .juiceColor = { 255, 109, 194, 255 }, .slashSound = donutSlashSound }
+};
 
 //////////////////////////////////////////////////////////////////////
 // LOADED PROPERTIES
 //////////////////////////////////////////////////////////////////////
 
 static Texture2D backgroundTexture;
-static Texture2D appleTexture;
-static Texture2D bananaTexture;
-static Texture2D cherryTexture;
-static Texture2D donutTexture;
+static Texture2D fruitTextures[fruitTypeCount];
+static Rectangle fruitSourceRects[fruitTypeCount];
+static bool fruitAtlasLoaded;
+static Texture2D particleTexture;
 static Music music;
-static Sound fruitSpawnSound;
-static Sound fruitSlashSound;
-static Sound donutSlashSound;
+static VoicePool voicePools[soundEffectCount];
 
 //////////////////////////////////////////////////////////////////////
 // PROPERTIES
 //////////////////////////////////////////////////////////////////////
 
-static GameState state;
-static Fruit fruits[MAX_FRUIT_COUNT];
-static Particle particles[MAX_PARTICLE_COUNT];
-static int nextFruitIndex;
-static int nextParticleIndex;
-static int score;
-static int fruitsSlashed;
-static float spawnElapsed;
-static float totalElapsed;
-static bool slashing;
+static bool profileOverlay;
+static bool useAtlas;
+static bool useTextureCache;
+static AssetLoader assetLoader;
+static Archive assetArchive;
+static bool assetsLoaded;
+static double startupTime;
+static const char *musicPath;
+static Thread musicThread;
+static Mutex musicMutex;
+static bool musicStreaming;
+static int musicUpdateCount;
+static double musicUpdateTime;
+static int musicSourceSize;
+static double musicSecondsStreamed;
+static bool firstFrameDrawn;
+static RenderQueue renderQueue;
 
 //////////////////////////////////////////////////////////////////////
 // FUNCTION PROTOTYPES
 //////////////////////////////////////////////////////////////////////
 
-static void Initialize();
+static void Initialize(int argc, char *argv[]);
+static void OpenAssetArchive(int argc, char *argv[]);
+static void DecodeAssets(void *argument);
+static void UploadAssets();
+static void FinishLoadingAssets();
+static const char *GetAssetPath(Asset asset);
+static void LoadFruitTextures(Image images[]);
+static void LoadVoicePool(VoicePool *pool, Wave wave, int voiceCount);
+static void PlayVoice(VoicePool *pool);
+static void UnloadVoicePool(VoicePool *pool);
+static void OpenMusic();
+static void StreamMusic(void *argument);
+static void RefillMusic();
+static void ToggleMusic();
+static void CloseMusic();
+static void LoadParticleTexture();
 static void Update();
 static void Draw();
 static void Terminate();
-static void UpdateStartState();
-static void UpdatePlayState();
-static void UpdateLoseState();
 static void DrawStartState();
 static void DrawPlayState();
 static void DrawLoseState();
-static void FromStartToPlayState();
-static void FromPlayToLoseState();
-static void FromLoseToStartState();
-static void SpawnFruit();
-static void SlashFruit(Fruit *fruit);
+static void DrawParticles();
+static void DrawEffects();
+static bool FillRenderQueue(float alpha);
+static void DrawRenderQueue();
+static void DrawProfileOverlay();
 
 //////////////////////////////////////////////////////////////////////
 // FUNCTIONS
@@ -167,309 +226,748 @@ static void SlashFruit(Fruit *fruit);
 
 int main(int argc, char *argv[])
 {
-    Initialize();
+    startupTime = GetProfileTime();
+    ConfigureSimulation(argc, argv);
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--headless") == 0)
+        {
+            return RunHeadless(argc, argv);
+        }
+    }
+    if (!InitializeSimulation())
+    {
+        TraceLog(LOG_ERROR, "SIMULATION: Cannot allocate the configured capacities");
+        return 1;
+    }
+    Initialize(argc, argv);
     while (!WindowShouldClose())
     {
+        BeginProfilePhase(framePhase);
         Update();
         Draw();
+        EndProfilePhase(framePhase);
+        EndProfileFrame();
     }
     Terminate();
     return 0;
 }
 
-static void Initialize()
+static void Initialize(int argc, char *argv[])
 {
     InitWindow(screenWidth, screenHeight, "Fruit Ninja");
     SetTargetFPS(targetFPS);
-    backgroundTexture = LoadTexture("Background.png");
-    appleTexture = LoadTexture("Apple.png");
-    bananaTexture = LoadTexture("Banana.png");
-    cherryTexture = LoadTexture("Cherry.png");
-    donutTexture = LoadTexture("Donut.png");
+    useAtlas = true;
+    useTextureCache = true;
+    for (int i = 1; i < argc; ++i)
+    {
+        useAtlas = useAtlas && strcmp(argv[i], "--no-atlas") != 0;
+        useTextureCache = useTextureCache && strcmp(argv[i], "--no-texture-cache") != 0;
+    }
+    LoadParticleTexture();
     InitAudioDevice();
-    music = LoadMusicStream("Music.wav");
-    PlayMusicStream(music);
-    fruitSlashSound = LoadSound("FruitSlash.wav");
-    fruitSpawnSound = LoadSound("FruitSpawn.wav");
-    donutSlashSound = LoadSound("DonutSlash.wav");
-    state = startState;
-    for (int i = 0; i < MAX_FRUIT_COUNT; ++i)
+    OpenAssetArchive(argc, argv);
+    // Without a worker, decode everything up front rather than not at all.
+    if (!InitializeMutex(&assetLoader.mutex) || !StartThread(&assetLoader.thread, DecodeAssets, NULL))
     {
-        fruits[i].enabled = false;
+        DecodeAssets(NULL);
     }
-    for (int i = 0; i < MAX_PARTICLE_COUNT; ++i)
+    TraceLog(LOG_INFO, "SIMULATION: Seed %llu", simulationSeed);
+    for (int i = 1; i < argc - 1; ++i)
     {
-        particles[i].enabled = false;
+        if (strcmp(argv[i], "--record") == 0 && !StartRecording(argv[i + 1]))
+        {
+            TraceLog(LOG_WARNING, "SIMULATION: Cannot record to %s", argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--profile-csv") == 0 && !StartProfileCsv(argv[i + 1]))
+        {
+            TraceLog(LOG_WARNING, "PROFILER: Cannot write to %s", argv[i + 1]);
+        }
     }
-    nextFruitIndex = 0;
-    nextParticleIndex = 0;
-    fruitsSlashed = 0;
-    spawnElapsed = 0;
-    totalElapsed = 0;
-    slashing = false;
     HideCursor();
 }
 
-static void Update()
+// Assets come from FruitNinja.pak (or the archive given by --archive) when it
+// opens. Anything missing from it falls back to the loose file.
+static void OpenAssetArchive(int argc, char *argv[])
 {
-    UpdateMusicStream(music);
-    if (IsKeyPressed(KEY_M))
+    const char *archivePath = "FruitNinja.pak";
+    for (int i = 1; i < argc - 1; ++i)
     {
-        IsMusicPlaying(music) ? PauseMusicStream(music) : ResumeMusicStream(music);
+        if (strcmp(argv[i], "--archive") == 0)
+        {
+            archivePath = argv[i + 1];
+        }
     }
-    if (state == startState)
+    if (OpenArchive(&assetArchive, archivePath))
     {
-        UpdateStartState();
+        TraceLog(LOG_INFO, "ARCHIVE: Mapped %s with %d entries", archivePath, assetArchive.entryCount);
     }
-    else if (state == playState)
+}
+
+// Runs on the worker thread, so it only touches CPU-side raylib calls. Archive
+// entries decode in place from the mapping, and images go through the texture
+// cache unless --no-texture-cache is given.
+static void DecodeAssets(void *argument)
+{
+    (void)argument;
+    for (int i = 0; i < assetCount; ++i)
     {
-        UpdatePlayState();
+        int size = 0;
+        const char *path = GetAssetPath(i);
+        const unsigned char *data = FindArchiveEntry(&assetArchive, path, &size);
+        if (i < fruitSpawnAsset && useTextureCache)
+        {
+            assetLoader.images[i] = LoadCachedImage(path, data, size);
+        }
+        else if (i < fruitSpawnAsset)
+        {
+            assetLoader.images[i] = data != NULL ? LoadImageFromMemory(GetFileExtension(path), data, size) : LoadImage(path);
+        }
+        else
+        {
+            assetLoader.waves[i - fruitSpawnAsset] = data != NULL ? LoadWaveFromMemory(GetFileExtension(path), data, size) : LoadWave(path);
+        }
+        if (assetLoader.mutex.handle != NULL)
+        {
+            LockMutex(&assetLoader.mutex);
+        }
+        ++assetLoader.decodedCount;
+        if (assetLoader.mutex.handle != NULL)
+        {
+            UnlockMutex(&assetLoader.mutex);
+        }
     }
-    else if (state == loseState)
+}
+
+// Called every frame until loading finishes. GPU and audio device work has to
+// happen here on the main thread. The fruit textures wait for all the fruit
+// images, which the atlas needs together.
+static void UploadAssets()
+{
+    if (assetsLoaded)
     {
-        UpdateLoseState();
+        return;
     }
+    int decodedCount = assetCount;
+    if (assetLoader.mutex.handle != NULL)
+    {
+        LockMutex(&assetLoader.mutex);
+        decodedCount = assetLoader.decodedCount;
+        UnlockMutex(&assetLoader.mutex);
+    }
+    for (; assetLoader.uploadedCount < decodedCount; ++assetLoader.uploadedCount)
+    {
+        const int i = assetLoader.uploadedCount;
+        if (i == backgroundAsset)
+        {
+            backgroundTexture = LoadTextureFromImage(assetLoader.images[i]);
+            UnloadImage(assetLoader.images[i]);
+        }
+        else if (i == fruitSpawnAsset - 1)
+        {
+            LoadFruitTextures(&assetLoader.images[firstFruitAsset]);
+        }
+        else if (i >= fruitSpawnAsset)
+        {
+            const SoundEffect sound = i - fruitSpawnAsset;
+            LoadVoicePool(&voicePools[sound], assetLoader.waves[sound], voiceLimits[sound]);
+            UnloadWave(assetLoader.waves[sound]);
+        }
+    }
+    if (assetLoader.uploadedCount < assetCount)
+    {
+        return;
+    }
+    JoinThread(&assetLoader.thread);
+    TerminateMutex(&assetLoader.mutex);
+    assetsLoaded = true;
+    TraceLog(LOG_INFO, "STARTUP: Assets loaded after %.1f ms", (GetProfileTime() - startupTime) * 1000);
 }
 
-static void Draw()
+// Blocks until every asset is uploaded, for shutting down mid-load.
+static void FinishLoadingAssets()
 {
-    BeginDrawing();
-    ClearBackground(BLACK);
-    DrawTexture(backgroundTexture, 0, 0, WHITE);
-    const Vector2 mousePosition = GetMousePosition();
-    DrawCircle(mousePosition.x, mousePosition.y, mouseRadius, slashing ? GREEN : WHITE);
-    if (state == startState)
+    JoinThread(&assetLoader.thread);
+    TerminateMutex(&assetLoader.mutex);
+    UploadAssets();
+}
+
+// Fruit sprites are named in fruitAppearances, so a new fruit type needs no
+// entry here.
+static const char *GetAssetPath(Asset asset)
+{
+    if (asset == backgroundAsset)
     {
-        DrawStartState();
+        return backgroundPath;
     }
-    else if (state == playState)
+    if (asset < fruitSpawnAsset)
     {
-        DrawPlayState();
+        return fruitAppearances[asset - firstFruitAsset].spritePath;
     }
-    else if (state == loseState)
+    return soundPaths[asset - fruitSpawnAsset];
+}
+
+// By default the fruit sprites are packed side by side into one atlas texture,
+// so that every fruit is drawn without switching textures. --no-atlas uploads
+// them separately for comparison. Takes ownership of the images.
+static void LoadFruitTextures(Image images[])
+{
+    fruitAtlasLoaded = useAtlas;
+    if (!useAtlas)
     {
-        DrawLoseState();
+        for (int i = 0; i < fruitTypeCount; ++i)
+        {
+            fruitTextures[i] = LoadTextureFromImage(images[i]);
+            fruitSourceRects[i] = (Rectangle) { 0, 0, fruitTextures[i].width, fruitTextures[i].height };
+            UnloadImage(images[i]);
+        }
+        return;
+    }
+    int width = 0;
+    int height = 0;
+    for (int i = 0; i < fruitTypeCount; ++i)
+    {
+        width += images[i].width;
+        height = images[i].height > height ? images[i].height : height;
+    }
+    Image atlas = GenImageColor(width, height, BLANK);
+    int x = 0;
+    for (int i = 0; i < fruitTypeCount; ++i)
+    {
+        fruitSourceRects[i] = (Rectangle) { x, 0, images[i].width, images[i].height };
+        ImageDraw(&atlas, images[i], (Rectangle) { 0, 0, images[i].width, images[i].height }, fruitSourceRects[i], WHITE);
+        x += images[i].width;
+        UnloadImage(images[i]);
+    }
+    const Texture2D atlasTexture = LoadTextureFromImage(atlas);
+    UnloadImage(atlas);
+    for (int i = 0; i < fruitTypeCount; ++i)
+    {
+        fruitTextures[i] = atlasTexture;
     }
-    EndDrawing();
 }
 
-static void Terminate()
+// Rasterizes the trail circle once, so particles can be drawn as textured quads
+// in one batch instead of tessellating a fan for every DrawCircle call.
+static void LoadParticleTexture()
 {
-    UnloadTexture(backgroundTexture);
-    UnloadTexture(appleTexture);
-    UnloadTexture(bananaTexture);
-    UnloadTexture(cherryTexture);
-    UnloadTexture(donutTexture);
-    UnloadMusicStream(music);
-    UnloadSound(fruitSlashSound);
-    UnloadSound(fruitSpawnSound);
-    UnloadSound(donutSlashSound);
-    CloseAudioDevice();
-    CloseWindow();
+    const int size = mouseRadius * 2 + 1;
+    Image image = GenImageColor(size, size, BLANK);
+    ImageDrawCircle(&image, mouseRadius, mouseRadius, mouseRadius, WHITE);
+    particleTexture = LoadTextureFromImage(image);
+    UnloadImage(image);
 }
 
-static void UpdateStartState()
+// A sound that failed to load, such as a missing file, leaves the pool empty
+// and silent, because raylib cannot alias a sound without a buffer.
+static void LoadVoicePool(VoicePool *pool, Wave wave, int voiceCount)
 {
-    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+    pool->voices[0] = LoadSoundFromWave(wave);
+    if (pool->voices[0].stream.buffer == NULL)
     {
-        FromStartToPlayState();
+        pool->count = 0;
+        return;
     }
+    for (int i = 1; i < voiceCount; ++i)
+    {
+        pool->voices[i] = LoadSoundAlias(pool->voices[0]);
+    }
+    pool->count = voiceCount;
 }
 
-static void UpdatePlayState()
+// Starts an idle voice, or restarts the voice that started longest ago once
+// every voice is busy, so bursts of the same sound cannot pile up without limit.
+static void PlayVoice(VoicePool *pool)
 {
-    totalElapsed += GetFrameTime();
-    spawnElapsed += GetFrameTime();
-    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+    if (pool->count == 0)
     {
-        slashing = true;
+        return;
     }
-    else if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON))
+    int voice = 0;
+    for (int i = 0; i < pool->count; ++i)
     {
-        slashing = false;
+        if (!IsSoundPlaying(pool->voices[i]))
+        {
+            voice = i;
+            break;
+        }
+        if (pool->playOrder[i] < pool->playOrder[voice])
+        {
+            voice = i;
+        }
     }
-    if (slashing)
+    pool->playOrder[voice] = ++pool->playCount;
+    PlaySound(pool->voices[voice]);
+}
+
+static void UnloadVoicePool(VoicePool *pool)
+{
+    for (int i = pool->count - 1; i > 0; --i)
+    {
+        UnloadSoundAlias(pool->voices[i]);
+    }
+    if (pool->count > 0)
     {
-        particles[nextParticleIndex].position = GetMousePosition();
-        particles[nextParticleIndex].elapsed = 0;
-        particles[nextParticleIndex].enabled = true;
-        nextParticleIndex = (nextParticleIndex + 1) % MAX_PARTICLE_COUNT;
+        UnloadSound(pool->voices[0]);
     }
-    for (int i = 0; i < MAX_PARTICLE_COUNT; ++i)
+    pool->count = 0;
+}
+
+// Picks the first music file found, in the archive or on disk, preferring the
+// compressed formats: QOA decodes cheaply, OGG is smallest, and WAV is the
+// uncompressed fallback. Streamed music reads from the archive mapping for as
+// long as it plays.
+static void OpenMusic()
+{
+    musicPath = musicPaths[sizeof(musicPaths) / sizeof(musicPaths[0]) - 1];
+    for (int i = 0; i < (int)(sizeof(musicPaths) / sizeof(musicPaths[0])); ++i)
     {
-        if (particles[i].enabled)
+        int size = 0;
+        if (FindArchiveEntry(&assetArchive, musicPaths[i], &size) != NULL || FileExists(musicPaths[i]))
         {
-            particles[i].elapsed += GetFrameTime();
-            if (particles[i].elapsed > particleMaximumElapsed)
-            {
-                particles[i].enabled = false;
-            }
+            musicPath = musicPaths[i];
+            break;
         }
     }
-    const float spawnElapsedThreshold = minimumSpawnRate - totalElapsed / maximumElapsed;
-    if (spawnElapsed > (spawnElapsedThreshold < maximumSpawnRate ? maximumSpawnRate : spawnElapsedThreshold))
+    int musicSize = 0;
+    const unsigned char *musicData = FindArchiveEntry(&assetArchive, musicPath, &musicSize);
+    music = musicData != NULL ? LoadMusicStreamFromMemory(GetFileExtension(musicPath), musicData, musicSize) : LoadMusicStream(musicPath);
+    musicSourceSize = musicData != NULL ? musicSize : GetFileLength(musicPath);
+    PlayMusicStream(music);
+    musicStreaming = true;
+    if (InitializeMutex(&musicMutex) && !StartThread(&musicThread, StreamMusic, NULL))
     {
-        spawnElapsed = 0;
-        SpawnFruit();
+        TerminateMutex(&musicMutex);
     }
-    for (int i = 0; i < MAX_FRUIT_COUNT; ++i)
+    TraceLog(LOG_INFO, "MUSIC: Streaming %s on the %s thread", musicPath, musicThread.handle != NULL ? "music" : "main");
+}
+
+// Refills the stream buffers in the background, so that reading and decoding
+// never lands on a frame.
+static void StreamMusic(void *argument)
+{
+    (void)argument;
+    for (;;)
     {
-        if (fruits[i].enabled)
+        LockMutex(&musicMutex);
+        const bool streaming = musicStreaming;
+        if (streaming)
+        {
+            RefillMusic();
+        }
+        UnlockMutex(&musicMutex);
+        if (!streaming)
         {
-            if (fruits[i].position.y > screenHeight)
-            {
-                fruits[i].enabled = false;
-            }
-            else if (slashing && CheckCollisionPointCircle(GetMousePosition(), (Vector2) { fruits[i].position.x + fruitRadius, fruits[i].position.y + fruitRadius }, fruitRadius))
-            {
-                SlashFruit(&fruits[i]);
-            }
-            else
-            {
-                fruits[i].position.x += fruits[i].velocity.x;
-                fruits[i].position.y += fruits[i].velocity.y;
-                fruits[i].velocity.y -= gravity;
-            }
+            return;
         }
+        SleepThread(musicUpdateInterval);
     }
 }
 
-static void UpdateLoseState()
+// Times each refill and adds up how much audio has gone out, so that formats
+// can be compared by decode time and by bytes read from the source.
+static void RefillMusic()
 {
-    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+    const float playedBefore = GetMusicTimePlayed(music);
+    const double start = GetProfileTime();
+    UpdateMusicStream(music);
+    musicUpdateTime += GetProfileTime() - start;
+    ++musicUpdateCount;
+    float played = GetMusicTimePlayed(music) - playedBefore;
+    // The position wraps around when the track loops.
+    if (played < 0)
     {
-        FromLoseToStartState();
+        played += GetMusicTimeLength(music);
     }
+    musicSecondsStreamed += played;
 }
 
-static void DrawStartState()
+static void ToggleMusic()
 {
-    DrawText("Fruit Ninja", screenHalfWidth - MeasureText("Fruit Ninja", largeTextSize) * 0.5, screenHeight * 0.4 - largeTextSize * 0.5, largeTextSize, WHITE);
-    DrawText("Press SLASH To Play!", screenHalfWidth - MeasureText("Press SLASH To Play!", normalTextSize) * 0.5, screenHeight * 0.6 - largeTextSize * 0.5, normalTextSize, WHITE);
+    if (musicThread.handle != NULL)
+    {
+        LockMutex(&musicMutex);
+    }
+    IsMusicPlaying(music) ? PauseMusicStream(music) : ResumeMusicStream(music);
+    if (musicThread.handle != NULL)
+    {
+        UnlockMutex(&musicMutex);
+    }
 }
 
-static void DrawPlayState()
+static void CloseMusic()
+{
+    if (musicThread.handle != NULL)
+    {
+        LockMutex(&musicMutex);
+        musicStreaming = false;
+        UnlockMutex(&musicMutex);
+        JoinThread(&musicThread);
+        TerminateMutex(&musicMutex);
+    }
+    // Bytes streamed are estimated from the share of the track played.
+    const float length = GetMusicTimeLength(music);
+    TraceLog(LOG_INFO, "MUSIC: %s is %d bytes for %.1f s, about %.0f bytes streamed over %.1f s", musicPath, musicSourceSize, length, length > 0 ? musicSourceSize * musicSecondsStreamed / length : 0.0, musicSecondsStreamed);
+    TraceLog(LOG_INFO, "MUSIC: %s took %.3f ms per update over %d updates", musicPath, musicUpdateCount > 0 ? musicUpdateTime * 1000 / musicUpdateCount : 0.0, musicUpdateCount);
+    UnloadMusicStream(music);
+}
+
+static void Update()
 {
-    for (int i = 0; i < MAX_PARTICLE_COUNT; ++i)
+    // Music opens here rather than in UploadAssets, so that shutting down
+    // mid-load does not start a stream only to close it again.
+    if (!assetsLoaded)
     {
-        if (particles[i].enabled)
+        UploadAssets();
+        if (assetsLoaded)
         {
-            DrawCircle(particles[i].position.x, particles[i].position.y, mouseRadius, GREEN);
+            OpenMusic();
         }
     }
-    for (int i = 0; i < MAX_FRUIT_COUNT; ++i)
+    // Only runs when the music thread could not start.
+    if (musicThread.handle == NULL)
+    {
+        BeginProfilePhase(musicPhase);
+        RefillMusic();
+        EndProfilePhase(musicPhase);
+    }
+    if (IsKeyPressed(KEY_M))
+    {
+        ToggleMusic();
+    }
+    if (IsKeyPressed(KEY_F1))
+    {
+        profileOverlay = !profileOverlay;
+        profiling = profileOverlay || IsProfileCsvOpen();
+    }
+    // Play cannot start until the fruit and sounds it needs are uploaded.
+    const SimulationInput input = { GetMousePosition(), assetsLoaded && IsMouseButtonPressed(MOUSE_LEFT_BUTTON), IsMouseButtonReleased(MOUSE_LEFT_BUTTON) };
+    UpdateSimulation(input, GetFrameTime());
+    // Every event gets a voice, up to the sound's limit for the frame.
+    int eventCounts[soundEffectCount] = { 0 };
+    eventCounts[fruitSpawnSound] = simulationEvents.fruitsSpawned;
+    for (int type = 0; type < fruitTypeCount; ++type)
+    {
+        eventCounts[fruitAppearances[type].slashSound] += simulationEvents.slashed[type];
+    }
+    for (int sound = 0; sound < soundEffectCount; ++sound)
     {
-        if (fruits[i].enabled)
+        for (int i = 0; i < eventCounts[sound] && i < voiceLimits[sound]; ++i)
         {
-            if (fruits[i].type == appleType)
-            {
-                DrawTextureV(appleTexture, fruits[i].position, WHITE);
-            }
-            else if (fruits[i].type == bananaType)
-            {
-                DrawTextureV(bananaTexture, fruits[i].position, WHITE);
-            }
-            else if (fruits[i].type == cherryType)
-            {
-                DrawTextureV(cherryTexture, fruits[i].position, WHITE);
-            }
-            else if (fruits[i].type == donutType)
-            {
-                DrawTextureV(donutTexture, fruits[i].position, WHITE);
-            }
+            PlayVoice(&voicePools[sound]);
         }
     }
 }
 
-static void DrawLoseState()
+static void Draw()
 {
-    DrawText("You Slashed A Donut!", screenHalfWidth - MeasureText("You Slashed A Donut!", largeTextSize) * 0.5, screenHeight * 0.4 - largeTextSize * 0.5, largeTextSize, WHITE);
-    char slashedBuffer[32];
-    sprintf(slashedBuffer, "Fruits Slashed: %d", fruitsSlashed);
-    DrawText(slashedBuffer, screenHalfWidth - MeasureText(slashedBuffer, normalTextSize) * 0.5, screenHeight * 0.6 - largeTextSize * 0.5, normalTextSize, WHITE);
-    char scoreBuffer[32];
-    sprintf(scoreBuffer, "Score: %d", score);
-    DrawText(scoreBuffer, screenHalfWidth - MeasureText(scoreBuffer, normalTextSize) * 0.5, screenHeight * 0.6 - normalTextSize * 1.5 - largeTextSize * 0.5, normalTextSize, WHITE);
+    BeginDrawing();
+    ClearBackground(BLACK);
+    if (backgroundTexture.id != 0)
+    {
+        DrawTexture(backgroundTexture, 0, 0, WHITE);
+    }
+    SetProfileCounter(fruitCounter, 0);
+    SetProfileCounter(drawCallCounter, 0);
+    const Vector2 mousePosition = GetMousePosition();
+    DrawCircle(mousePosition.x, mousePosition.y, mouseRadius, slashing ? GREEN : WHITE);
+    if (state == startState)
+    {
+        BeginProfilePhase(drawStartPhase);
+        DrawStartState();
+        EndProfilePhase(drawStartPhase);
+    }
+    else if (state == playState)
+    {
+        BeginProfilePhase(drawPlayPhase);
+        DrawPlayState();
+        EndProfilePhase(drawPlayPhase);
+    }
+    else if (state == loseState)
+    {
+        BeginProfilePhase(drawLosePhase);
+        DrawLoseState();
+        EndProfilePhase(drawLosePhase);
+    }
+    DrawEffects();
+    if (profileOverlay)
+    {
+        DrawProfileOverlay();
+    }
+    EndDrawing();
+    if (!firstFrameDrawn)
+    {
+        firstFrameDrawn = true;
+        TraceLog(LOG_INFO, "STARTUP: First frame after %.1f ms", (GetProfileTime() - startupTime) * 1000);
+    }
 }
 
-static void FromStartToPlayState()
+static void Terminate()
 {
-    state = playState;
+    FinishLoadingAssets();
+    UnloadTexture(backgroundTexture);
+    for (int i = 0; i < (fruitAtlasLoaded ? 1 : fruitTypeCount); ++i)
+    {
+        UnloadTexture(fruitTextures[i]);
+    }
+    UnloadTexture(particleTexture);
+    free(renderQueue.x);
+    free(renderQueue.y);
+    CloseMusic();
+    CloseArchive(&assetArchive);
+    for (int i = 0; i < soundEffectCount; ++i)
+    {
+        UnloadVoicePool(&voicePools[i]);
+    }
+    StopRecording();
+    StopProfileCsv();
+    TerminateSimulation();
+    CloseAudioDevice();
+    CloseWindow();
 }
 
-static void FromPlayToLoseState()
+static void DrawStartState()
 {
-    state = loseState;
-    for (int i = 0; i < MAX_FRUIT_COUNT; ++i)
+    DrawText("Fruit Ninja", screenHalfWidth - MeasureText("Fruit Ninja", largeTextSize) * 0.5, screenHeight * 0.4 - largeTextSize * 0.5, largeTextSize, WHITE);
+    const char *prompt = assetsLoaded ? "Press SLASH To Play!" : "Loading...";
+    DrawText(prompt, screenHalfWidth - MeasureText(prompt, normalTextSize) * 0.5, screenHeight * 0.6 - largeTextSize * 0.5, normalTextSize, WHITE);
+}
+
+static void DrawPlayState()
+{
+    DrawParticles();
+    // Blend between the last two simulation steps by the time left over in the
+    // accumulator, so motion stays smooth when the rates do not line up.
+    if (FillRenderQueue(simulationAccumulator / simulationStep))
     {
-        fruits[i].enabled = false;
+        DrawRenderQueue();
     }
-    for (int i = 0; i < MAX_PARTICLE_COUNT; ++i)
+}
+
+// The white circle texture is tinted green through the vertex color, matching
+// the look of the old DrawCircle trail.
+static void DrawParticles()
+{
+    rlSetTexture(particleTexture.id);
+    rlBegin(RL_QUADS);
+    rlColor4ub(GREEN.r, GREEN.g, GREEN.b, GREEN.a);
+    rlNormal3f(0, 0, 1);
+    for (int i = 0; i < particleCount; ++i)
     {
-        particles[i].enabled = false;
+        const Particle particle = particles[(particleTail + i) % particleCapacity];
+        const float x = particle.position.x - mouseRadius;
+        const float y = particle.position.y - mouseRadius;
+        rlCheckRenderBatchLimit(4);
+        rlTexCoord2f(0, 0);
+        rlVertex2f(x, y);
+        rlTexCoord2f(0, 1);
+        rlVertex2f(x, y + particleTexture.height);
+        rlTexCoord2f(1, 1);
+        rlVertex2f(x + particleTexture.width, y + particleTexture.height);
+        rlTexCoord2f(1, 0);
+        rlVertex2f(x + particleTexture.width, y);
     }
-    spawnElapsed = 0;
-    totalElapsed = 0;
-    slashing = false;
+    rlEnd();
+    rlSetTexture(0);
 }
 
-static void FromLoseToStartState()
+// Juice droplets reuse the trail circle at a smaller size, fading out over
+// their lifetime. Each fruit half draws one side of its sprite, rotated about
+// its center.
+static void DrawEffects()
 {
-    state = startState;
-    fruitsSlashed = 0;
-    score = 0;
+    rlSetTexture(particleTexture.id);
+    rlBegin(RL_QUADS);
+    rlNormal3f(0, 0, 1);
+    for (int i = 0; i < effects.count; ++i)
+    {
+        if (effects.kind[i] != juiceEffect)
+        {
+            continue;
+        }
+        const Color color = fruitAppearances[effects.type[i]].juiceColor;
+        const float x = effects.x[i] - juiceRadius;
+        const float y = effects.y[i] - juiceRadius;
+        rlCheckRenderBatchLimit(4);
+        rlColor4ub(color.r, color.g, color.b, color.a * (1 - effects.elapsed[i] / effects.lifetime[i]));
+        rlTexCoord2f(0, 0);
+        rlVertex2f(x, y);
+        rlTexCoord2f(0, 1);
+        rlVertex2f(x, y + juiceRadius * 2);
+        rlTexCoord2f(1, 1);
+        rlVertex2f(x + juiceRadius * 2, y + juiceRadius * 2);
+        rlTexCoord2f(1, 0);
+        rlVertex2f(x + juiceRadius * 2, y);
+    }
+    rlEnd();
+    for (int i = 0; i < effects.count; ++i)
+    {
+        if (effects.kind[i] == juiceEffect)
+        {
+            continue;
+        }
+        const Texture2D texture = fruitTextures[effects.type[i]];
+        Rectangle source = fruitSourceRects[effects.type[i]];
+        source.width *= 0.5;
+        source.x += effects.kind[i] == rightHalfEffect ? source.width : 0;
+        const float left = source.x / texture.width;
+        const float right = (source.x + source.width) / texture.width;
+        const float top = source.y / texture.height;
+        const float bottom = (source.y + source.height) / texture.height;
+        const float cosine = cosf(effects.angle[i]);
+        const float sine = sinf(effects.angle[i]);
+        const float halfWidth = source.width * 0.5;
+        const float halfHeight = source.height * 0.5;
+        const float cornerX[4] = { -halfWidth, -halfWidth, halfWidth, halfWidth };
+        const float cornerY[4] = { -halfHeight, halfHeight, halfHeight, -halfHeight };
+        const float u[4] = { left, left, right, right };
+        const float v[4] = { top, bottom, bottom, top };
+        rlSetTexture(texture.id);
+        rlBegin(RL_QUADS);
+        rlColor4ub(WHITE.r, WHITE.g, WHITE.b, WHITE.a);
+        rlNormal3f(0, 0, 1);
+        rlCheckRenderBatchLimit(4);
+        for (int corner = 0; corner < 4; ++corner)
+        {
+            rlTexCoord2f(u[corner], v[corner]);
+            rlVertex2f(effects.x[i] + cornerX[corner] * cosine - cornerY[corner] * sine, effects.y[i] + cornerX[corner] * sine + cornerY[corner] * cosine);
+        }
+        rlEnd();
+    }
+    rlSetTexture(0);
+    SetProfileCounter(effectCounter, effects.count);
 }
 
-static void SpawnFruit()
+// Returns false, leaving the queue as it was, when it cannot grow to hold every
+// fruit, and the fruit are not drawn that frame.
+static bool FillRenderQueue(float alpha)
 {
-    PlaySound(fruitSpawnSound);
-    const int spawnValue = GetRandomValue(1, 100);
-    if (spawnValue <= appleSpawnCeiling)
+    if (renderQueue.capacity < fruits.count)
     {
-        fruits[nextFruitIndex].type = appleType;
+        float *x = realloc(renderQueue.x, fruits.allocated * sizeof(float));
+        if (x == NULL)
+        {
+            return false;
+        }
+        renderQueue.x = x;
+        float *y = realloc(renderQueue.y, fruits.allocated * sizeof(float));
+        if (y == NULL)
+        {
+            return false;
+        }
+        renderQueue.y = y;
+        renderQueue.capacity = fruits.allocated;
     }
-    else if (spawnValue <= bananaSpawnCeiling)
+    int bucketCount[fruitTypeCount] = { 0 };
+    for (int i = 0; i < fruits.count; ++i)
     {
-        fruits[nextFruitIndex].type = bananaType;
+        ++bucketCount[fruits.type[i]];
     }
-    else if (spawnValue <= cherrySpawnCeiling)
+    int next[fruitTypeCount];
+    renderQueue.bucketStart[0] = 0;
+    for (int i = 0; i < fruitTypeCount; ++i)
     {
-        fruits[nextFruitIndex].type = cherryType;
+        next[i] = renderQueue.bucketStart[i];
+        renderQueue.bucketStart[i + 1] = renderQueue.bucketStart[i] + bucketCount[i];
     }
-    else if (spawnValue <= donutSpawnCeiling)
+    for (int i = 0; i < fruits.count; ++i)
     {
-        fruits[nextFruitIndex].type = donutType;
+        const int entry = next[fruits.type[i]]++;
+        renderQueue.x[entry] = fruits.previousX[i] + (fruits.x[i] - fruits.previousX[i]) * alpha;
+        renderQueue.y[entry] = fruits.previousY[i] + (fruits.y[i] - fruits.previousY[i]) * alpha;
     }
-    fruits[nextFruitIndex].position = (Vector2) { GetRandomValue(screenWidth * 0.25, screenWidth * 0.75), screenHeight };
-    fruits[nextFruitIndex].velocity = (Vector2) { GetRandomValue(minimumFruitStrafe, maximumFruitStrafe), -GetRandomValue(minimumFruitThrust, maximumFruitThrust) };
-    fruits[nextFruitIndex].enabled = true;
-    nextFruitIndex = (nextFruitIndex + 1) % MAX_FRUIT_COUNT;
+    return true;
 }
 
-static void SlashFruit(Fruit *fruit)
+// Emits each bucket as rlgl quads, binding a texture only when it differs from
+// the previous bucket's. With the atlas every bucket shares one texture, so all
+// fruit land in a single draw call until rlgl's vertex buffer fills up. Those
+// flushes are counted as draw calls too.
+static void DrawRenderQueue()
 {
-    fruit->enabled = false;
-    if (fruit->type == appleType)
+    unsigned int boundTexture = 0;
+    int drawCalls = 0;
+    rlBegin(RL_QUADS);
+    rlColor4ub(WHITE.r, WHITE.g, WHITE.b, WHITE.a);
+    rlNormal3f(0, 0, 1);
+    for (int type = 0; type < fruitTypeCount; ++type)
     {
-        ++fruitsSlashed;
-        score += appleScore;
-        PlaySound(fruitSlashSound);
+        if (renderQueue.bucketStart[type] == renderQueue.bucketStart[type + 1])
+        {
+            continue;
+        }
+        const Texture2D texture = fruitTextures[type];
+        if (texture.id != boundTexture)
+        {
+            rlSetTexture(texture.id);
+            boundTexture = texture.id;
+            ++drawCalls;
+        }
+        const Rectangle source = fruitSourceRects[type];
+        const float left = source.x / texture.width;
+        const float right = (source.x + source.width) / texture.width;
+        const float top = source.y / texture.height;
+        const float bottom = (source.y + source.height) / texture.height;
+        for (int i = renderQueue.bucketStart[type]; i < renderQueue.bucketStart[type + 1]; ++i)
+        {
+            const float x = renderQueue.x[i];
+            const float y = renderQueue.y[i];
+            drawCalls += rlCheckRenderBatchLimit(4);
+            rlTexCoord2f(left, top);
+            rlVertex2f(x, y);
+            rlTexCoord2f(left, bottom);
+            rlVertex2f(x, y + source.height);
+            rlTexCoord2f(right, bottom);
+            rlVertex2f(x + source.width, y + source.height);
+            rlTexCoord2f(right, top);
+            rlVertex2f(x + source.width, y);
+        }
     }
-    else if (fruit->type == bananaType)
+    rlEnd();
+    rlSetTexture(0);
+    SetProfileCounter(fruitCounter, fruits.count);
+    SetProfileCounter(drawCallCounter, drawCalls);
+}
+
+static void DrawLoseState()
+{
+    DrawText("You Slashed A Donut!", screenHalfWidth - MeasureText("You Slashed A Donut!", largeTextSize) * 0.5, screenHeight * 0.4 - largeTextSize * 0.5, largeTextSize, WHITE);
+    char slashedBuffer[32];
+    sprintf(slashedBuffer, "Fruits Slashed: %d", fruitsSlashed);
+    DrawText(slashedBuffer, screenHalfWidth - MeasureText(slashedBuffer, normalTextSize) * 0.5, screenHeight * 0.6 - largeTextSize * 0.5, normalTextSize, WHITE);
+    char scoreBuffer[32];
+    sprintf(scoreBuffer, "Score: %d", score);
+    DrawText(scoreBuffer, screenHalfWidth - MeasureText(scoreBuffer, normalTextSize) * 0.5, screenHeight * 0.6 - normalTextSize * 1.5 - largeTextSize * 0.5, normalTextSize, WHITE);
+}
+
+// Milliseconds per frame for each phase over the last few seconds of frames.
+static void DrawProfileOverlay()
+{
+    const int lineHeight = profileTextSize + 4;
+    const char *headings[] = { "phase", "min", "avg", "p99" };
+    DrawRectangle(4, 4, 240, lineHeight * (profilePhaseCount + profileCounterCount + 1) + 8, (Color) { 0, 0, 0, 180 });
+    for (int column = 0; column < 4; ++column)
     {
-        ++fruitsSlashed;
-        score += bananaScore;
-        PlaySound(fruitSlashSound);
+        DrawText(headings[column], 8 + column * 56 + (column > 0) * 24, 8, profileTextSize, WHITE);
     }
-    else if (fruit->type == cherryType)
+    for (int i = 0; i < profilePhaseCount; ++i)
     {
-        ++fruitsSlashed;
-        score += cherryScore;
-        PlaySound(fruitSlashSound);
+        const ProfileStatistics statistics = GetProfileStatistics(i);
+        const double values[] = { statistics.minimum, statistics.average, statistics.percentile99 };
+        const int y = 8 + lineHeight * (i + 1);
+        DrawText(GetProfilePhaseName(i), 8, y, profileTextSize, WHITE);
+        for (int column = 1; column < 4; ++column)
+        {
+            char valueBuffer[32];
+            sprintf(valueBuffer, "%.3f", values[column - 1]);
+            DrawText(valueBuffer, 8 + column * 56 + 24, y, profileTextSize, WHITE);
+        }
     }
-    else if (fruit->type == donutType)
+    for (int i = 0; i < profileCounterCount; ++i)
     {
-        PlaySound(donutSlashSound);
-        FromPlayToLoseState();
+        char counterBuffer[64];
+        sprintf(counterBuffer, "%s: %d", GetProfileCounterName(i), GetProfileCounter(i));
+        DrawText(counterBuffer, 8, 8 + lineHeight * (profilePhaseCount + i + 1), profileTextSize, WHITE);
     }
 }
\ No newline at end of file
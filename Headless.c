@@ -0,0 +1,157 @@
+//////////////////////////////////////////////////////////////////////
+// LICENSE
+//////////////////////////////////////////////////////////////////////
+
+// MIT License
+
+// Copyright (c) 2021 Klayton Kowalski
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// https://github.com/klaytonkowalski/game-fruit-ninja
+
+
+//////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////
+
+#include "Headless.h"
+#include "Replay.h"
+#include "Simulation.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//////////////////////////////////////////////////////////////////////
+// CONSTANTS
+//////////////////////////////////////////////////////////////////////
+
+static const int defaultSessionCount = 1000;
+static const float defaultSessionSeconds = 120;
+static const int slashFrames = 60;
+static const int restFrames = 30;
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTIONS
+//////////////////////////////////////////////////////////////////////
+
+// Plays --sessions rounds back to back at a simulated 60 frames per second. A
+// round ends when a donut is slashed or after --session-seconds of play. Round
+// n is seeded with the session seed plus n, so any round can be rerun alone.
+// With --replay, each given log is verified instead and the exit code reports
+// whether all of them reproduced.
+int RunHeadless(int argc, char *argv[])
+{
+    int sessionCount = defaultSessionCount;
+    float sessionSeconds = defaultSessionSeconds;
+    const char *recordPath = NULL;
+    int replayCount = 0;
+    int replayFailures = 0;
+    for (int i = 1; i < argc - 1; ++i)
+    {
+        if (strcmp(argv[i], "--sessions") == 0)
+        {
+            sessionCount = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--session-seconds") == 0)
+        {
+            sessionSeconds = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--record") == 0)
+        {
+            recordPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay") == 0)
+        {
+            ++replayCount;
+            replayFailures += RunReplay(argv[++i]) != 0;
+        }
+    }
+    if (replayCount > 0)
+    {
+        printf("replays: %d, failed: %d\n", replayCount, replayFailures);
+        return replayFailures > 0;
+    }
+    if (recordPath != NULL)
+    {
+        // A log holds a single seed, so only one round can be recorded.
+        sessionCount = 1;
+    }
+    if (!InitializeSimulation())
+    {
+        printf("cannot allocate the configured capacities\n");
+        return 1;
+    }
+    const unsigned long long seed = simulationSeed;
+    const int sessionFrames = sessionSeconds * targetFPS;
+    const float frameTime = 1.0 / targetFPS;
+    const clock_t startClock = clock();
+    long long totalScore = 0;
+    int bestScore = 0;
+    int sessionsLost = 0;
+    for (int session = 0; session < sessionCount; ++session)
+    {
+        SeedSimulation(seed + session);
+        ResetSimulation();
+        if (recordPath != NULL && !StartRecording(recordPath))
+        {
+            printf("cannot record to %s\n", recordPath);
+            return 1;
+        }
+        int frame = 0;
+        UpdateSimulation((SimulationInput) { GetSyntheticInput(frame).pointer, true, false }, frameTime);
+        for (frame = 1; frame <= sessionFrames && state == playState; ++frame)
+        {
+            UpdateSimulation(GetSyntheticInput(frame), frameTime);
+        }
+        sessionsLost += state == loseState;
+        totalScore += score;
+        bestScore = score > bestScore ? score : bestScore;
+        StopRecording();
+    }
+    const double seconds = (double)(clock() - startClock) / CLOCKS_PER_SEC;
+    printf("seed: %llu\n", seed);
+    printf("sessions: %d\n", sessionCount);
+    printf("sessions lost: %d\n", sessionsLost);
+    printf("average score: %.2f\n", sessionCount > 0 ? (double)totalScore / sessionCount : 0.0);
+    printf("best score: %d\n", bestScore);
+    printf("ticks: %llu\n", simulationTicks);
+    printf("seconds: %.3f\n", seconds);
+    printf("sessions per second: %.1f\n", seconds > 0 ? sessionCount / seconds : 0.0);
+    printf("ticks per second: %.0f\n", seconds > 0 ? simulationTicks / seconds : 0.0);
+    TerminateSimulation();
+    return 0;
+}
+
+// A scripted player that sweeps the pointer in a figure eight across the
+// playfield, slashing for a second and resting for half a second.
+SimulationInput GetSyntheticInput(int frame)
+{
+    const float t = (float)frame / targetFPS;
+    const int phase = frame % (slashFrames + restFrames);
+    SimulationInput input;
+    input.pointer.x = screenWidth * (0.5 + 0.4 * sinf(t * 1.3));
+    input.pointer.y = screenHeight * (0.5 + 0.35 * sinf(t * 2.6));
+    input.pressed = phase == 0;
+    input.released = phase == slashFrames;
+    return input;
+}
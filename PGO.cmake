@@ -0,0 +1,130 @@
+# https://github.com/klaytonkowalski/game-fruit-ninja
+#
+# Profile-guided optimization pipeline, run by the pgo target:
+#   1. builds a plain Release tree
+#   2. builds an instrumented tree and trains it on scripted headless sessions
+#      (spawning, slashing and losing rounds) plus short benchmark runs with
+#      large fruit stores
+#   3. rebuilds the same tree with the profiles
+#   4. benchmarks both builds BENCHMARK_REPEATS times, alternating between
+#      them so that machine load affects both alike, and prints the median
+#      timings and speedup for every fruit count
+#
+# The instrumented and optimized builds share one tree because GCC names its
+# profiles after the object file paths.
+#
+# Expects SOURCE_DIR, BINARY_DIR, C_COMPILER and C_COMPILER_ID, and optionally
+# NATIVE, TRAINING_SESSIONS, BENCHMARK_ARGUMENTS and BENCHMARK_REPEATS.
+
+cmake_minimum_required(VERSION 3.19)
+
+if(NOT TRAINING_SESSIONS)
+    set(TRAINING_SESSIONS 300)
+endif()
+if(NOT BENCHMARK_ARGUMENTS)
+    set(BENCHMARK_ARGUMENTS --seed 1 --seconds 2 --fruit-counts 48,1024,16384,262144)
+endif()
+if(NOT BENCHMARK_REPEATS)
+    set(BENCHMARK_REPEATS 5)
+endif()
+if(NOT NATIVE)
+    set(NATIVE OFF)
+endif()
+
+set(PROFILE_DIRECTORY ${BINARY_DIR}/profiles)
+set(BASELINE_DIRECTORY ${BINARY_DIR}/baseline)
+set(OPTIMIZED_DIRECTORY ${BINARY_DIR}/optimized)
+
+function(run_step)
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        list(JOIN ARGN " " command)
+        message(FATAL_ERROR "PGO: ${command} failed: ${result}")
+    endif()
+endfunction()
+
+# CMake math is integer only, so timings are compared in thousandths.
+function(to_thousandths value output)
+    string(REGEX MATCH "^([0-9]+)\\.?([0-9]*)" match "${value}")
+    string(SUBSTRING "${CMAKE_MATCH_2}000" 0 3 fraction)
+    string(REGEX REPLACE "^0+([0-9])" "\\1" thousandths "${CMAKE_MATCH_1}${fraction}")
+    set(${output} ${thousandths} PARENT_SCOPE)
+endfunction()
+
+function(format_thousandths thousandths output)
+    math(EXPR whole "${thousandths} / 1000")
+    math(EXPR fraction "${thousandths} % 1000 + 1000")
+    string(SUBSTRING ${fraction} 1 3 fraction)
+    set(${output} ${whole}.${fraction} PARENT_SCOPE)
+endfunction()
+
+# Median nsPerFruitTick, in thousandths, of one run across the repeated
+# benchmark files named <prefix>-<repeat>.json.
+function(median_thousandths prefix run output)
+    set(samples "")
+    foreach(repeat RANGE 1 ${BENCHMARK_REPEATS})
+        file(READ ${BINARY_DIR}/${prefix}-${repeat}.json results)
+        string(JSON time GET "${results}" runs ${run} nsPerFruitTick)
+        to_thousandths(${time} thousandths)
+        list(APPEND samples ${thousandths})
+    endforeach()
+    list(SORT samples COMPARE NATURAL)
+    math(EXPR middle "${BENCHMARK_REPEATS} / 2")
+    list(GET samples ${middle} median)
+    set(${output} ${median} PARENT_SCOPE)
+endfunction()
+
+function(configure_tree directory pgo)
+    run_step(${CMAKE_COMMAND} -S ${SOURCE_DIR} -B ${directory}
+        -DCMAKE_C_COMPILER=${C_COMPILER}
+        -DCMAKE_BUILD_TYPE=Release
+        -DFRUITNINJA_NATIVE=${NATIVE}
+        -DFRUITNINJA_PGO=${pgo}
+        -DFRUITNINJA_PGO_DIRECTORY=${PROFILE_DIRECTORY})
+endfunction()
+
+message(STATUS "PGO: building the baseline")
+configure_tree(${BASELINE_DIRECTORY} "")
+run_step(${CMAKE_COMMAND} --build ${BASELINE_DIRECTORY} --target Benchmark)
+
+message(STATUS "PGO: building the instrumented tree and training it")
+file(REMOVE_RECURSE ${PROFILE_DIRECTORY})
+file(MAKE_DIRECTORY ${PROFILE_DIRECTORY})
+configure_tree(${OPTIMIZED_DIRECTORY} GENERATE)
+run_step(${CMAKE_COMMAND} --build ${OPTIMIZED_DIRECTORY} --target FruitNinjaHeadless Benchmark --clean-first)
+run_step(${OPTIMIZED_DIRECTORY}/FruitNinjaHeadless --headless --seed 1 --sessions ${TRAINING_SESSIONS})
+run_step(${OPTIMIZED_DIRECTORY}/Benchmark --seed 2 --seconds 1 --fruit-counts 48,4096,65536 --output ${BINARY_DIR}/training.json)
+
+if(C_COMPILER_ID MATCHES "Clang")
+    find_program(LLVM_PROFDATA NAMES llvm-profdata REQUIRED)
+    file(GLOB RAW_PROFILES ${PROFILE_DIRECTORY}/*.profraw)
+    run_step(${LLVM_PROFDATA} merge -output=${PROFILE_DIRECTORY}/default.profdata ${RAW_PROFILES})
+endif()
+
+message(STATUS "PGO: rebuilding with the profiles")
+configure_tree(${OPTIMIZED_DIRECTORY} USE)
+run_step(${CMAKE_COMMAND} --build ${OPTIMIZED_DIRECTORY} --target FruitNinjaHeadless Benchmark --clean-first)
+
+message(STATUS "PGO: benchmarking both builds ${BENCHMARK_REPEATS} times")
+foreach(repeat RANGE 1 ${BENCHMARK_REPEATS})
+    run_step(${BASELINE_DIRECTORY}/Benchmark ${BENCHMARK_ARGUMENTS} --output ${BINARY_DIR}/baseline-${repeat}.json)
+    run_step(${OPTIMIZED_DIRECTORY}/Benchmark ${BENCHMARK_ARGUMENTS} --output ${BINARY_DIR}/optimized-${repeat}.json)
+endforeach()
+
+file(READ ${BINARY_DIR}/baseline-1.json baseline)
+string(JSON runCount LENGTH "${baseline}" runs)
+math(EXPR lastRun "${runCount} - 1")
+set(report "median of ${BENCHMARK_REPEATS} runs\nfruit\t\tbaseline ns\tpgo ns\t\tspeedup\n")
+foreach(run RANGE ${lastRun})
+    string(JSON fruitCount GET "${baseline}" runs ${run} fruitCount)
+    median_thousandths(baseline ${run} baselineThousandths)
+    median_thousandths(optimized ${run} optimizedThousandths)
+    math(EXPR speedup "${baselineThousandths} * 1000 / ${optimizedThousandths}")
+    format_thousandths(${baselineThousandths} baselineTime)
+    format_thousandths(${optimizedThousandths} optimizedTime)
+    format_thousandths(${speedup} speedup)
+    string(APPEND report "${fruitCount}\t\t${baselineTime}\t\t${optimizedTime}\t\t${speedup}x\n")
+endforeach()
+file(WRITE ${BINARY_DIR}/report.txt "${report}")
+message("${report}")
+message(STATUS "PGO: report written to ${BINARY_DIR}/report.txt")
@@ -0,0 +1,164 @@
+//////////////////////////////////////////////////////////////////////
+// LICENSE
+//////////////////////////////////////////////////////////////////////
+
+// MIT License
+
+// Copyright (c) 2021 Klayton Kowalski
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// https://github.com/klaytonkowalski/game-fruit-ninja
+
+
+// Packs asset files into one archive for Archive.c to map at startup. Entries
+// are named after the file name without its directory.
+//
+// Usage: Pack <archive> <file>...
+
+//////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////
+
+#include "Archive.h"
+#include "Binary.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////
+
+static const char *GetEntryName(const char *path);
+static unsigned char *ReadAssetFile(const char *path, uint64_t *size);
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTIONS
+//////////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        printf("usage: %s <archive> <file>...\n", argv[0]);
+        return 1;
+    }
+    const int entryCount = argc - 2;
+    for (int i = 0; i < entryCount; ++i)
+    {
+        if (strlen(GetEntryName(argv[i + 2])) >= ARCHIVE_NAME_SIZE)
+        {
+            printf("%s: name longer than %d bytes\n", argv[i + 2], ARCHIVE_NAME_SIZE - 1);
+            return 1;
+        }
+    }
+    FILE *archive = fopen(argv[1], "wb");
+    if (archive == NULL)
+    {
+        printf("%s: cannot write archive\n", argv[1]);
+        return 1;
+    }
+    fwrite("FNPK", 1, 4, archive);
+    WriteInteger(archive, ARCHIVE_VERSION, 4);
+    WriteInteger(archive, entryCount, 4);
+    WriteInteger(archive, 0, 4);
+    // The index is written as a placeholder and filled in once the data
+    // offsets are known.
+    const unsigned char emptyEntry[ARCHIVE_ENTRY_SIZE] = { 0 };
+    for (int i = 0; i < entryCount; ++i)
+    {
+        fwrite(emptyEntry, 1, ARCHIVE_ENTRY_SIZE, archive);
+    }
+    uint64_t offset = ARCHIVE_HEADER_SIZE + (uint64_t)entryCount * ARCHIVE_ENTRY_SIZE;
+    for (int i = 0; i < entryCount; ++i)
+    {
+        const char *path = argv[i + 2];
+        uint64_t size;
+        unsigned char *data = ReadAssetFile(path, &size);
+        if (data == NULL)
+        {
+            printf("%s: cannot read file\n", path);
+            fclose(archive);
+            remove(argv[1]);
+            return 1;
+        }
+        while (offset % ARCHIVE_ALIGNMENT != 0)
+        {
+            fputc(0, archive);
+            ++offset;
+        }
+        fwrite(data, 1, size, archive);
+        free(data);
+        char name[ARCHIVE_NAME_SIZE] = { 0 };
+        strcpy(name, GetEntryName(path));
+        fseek(archive, ARCHIVE_HEADER_SIZE + (long)i * ARCHIVE_ENTRY_SIZE, SEEK_SET);
+        fwrite(name, 1, ARCHIVE_NAME_SIZE, archive);
+        WriteInteger(archive, offset, 8);
+        WriteInteger(archive, size, 8);
+        fseek(archive, 0, SEEK_END);
+        printf("%s: %llu bytes at %llu\n", name, (unsigned long long)size, (unsigned long long)offset);
+        offset += size;
+    }
+    const bool written = ferror(archive) == 0;
+    fclose(archive);
+    if (!written)
+    {
+        printf("%s: write failed\n", argv[1]);
+        remove(argv[1]);
+        return 1;
+    }
+    return 0;
+}
+
+static const char *GetEntryName(const char *path)
+{
+    const char *name = path;
+    for (const char *c = path; *c != '\0'; ++c)
+    {
+        if (*c == '/' || *c == '\\')
+        {
+            name = c + 1;
+        }
+    }
+    return name;
+}
+
+static unsigned char *ReadAssetFile(const char *path, uint64_t *size)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    const long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char *data = length >= 0 ? malloc(length > 0 ? length : 1) : NULL;
+    if (data != NULL && fread(data, 1, length, file) != (size_t)length)
+    {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    *size = length;
+    return data;
+}
@@ -0,0 +1,247 @@
+//////////////////////////////////////////////////////////////////////
+// LICENSE
+//////////////////////////////////////////////////////////////////////
+
+// MIT License
+
+// Copyright (c) 2021 Klayton Kowalski
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// https://github.com/klaytonkowalski/game-fruit-ninja
+
+
+//////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////
+
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "Profiler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////
+// DEFINES
+//////////////////////////////////////////////////////////////////////
+
+#define PROFILE_WINDOW 240
+
+//////////////////////////////////////////////////////////////////////
+// CONSTANTS
+//////////////////////////////////////////////////////////////////////
+
+static const char *phaseNames[profilePhaseCount] =
+{
+    "frame",
+    "music",
+    "particles",
+    "spawning",
+    "fruit",
+    "effects",
+    "draw start",
+    "draw play",
+    "draw lose"
+};
+
+static const char *counterNames[profileCounterCount] =
+{
+    "fruit",
+    "fruit draw calls",
+    "effects"
+};
+
+//////////////////////////////////////////////////////////////////////
+// PROPERTIES
+//////////////////////////////////////////////////////////////////////
+
+bool profiling;
+static double phaseStart[profilePhaseCount];
+static double phaseElapsed[profilePhaseCount];
+static double window[profilePhaseCount][PROFILE_WINDOW];
+static int counters[profileCounterCount];
+static int windowIndex;
+static int windowCount;
+static FILE *csvFile;
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////
+
+static int CompareDoubles(const void *a, const void *b);
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTIONS
+//////////////////////////////////////////////////////////////////////
+
+// Seconds from a monotonic clock.
+double GetProfileTime()
+{
+#if defined(_WIN32)
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+void BeginProfilePhase(ProfilePhase phase)
+{
+    if (profiling)
+    {
+        phaseStart[phase] = GetProfileTime();
+    }
+}
+
+// Phases may run several times a frame, such as once per simulation step, so
+// their time is summed until the frame ends.
+void EndProfilePhase(ProfilePhase phase)
+{
+    if (profiling)
+    {
+        phaseElapsed[phase] += GetProfileTime() - phaseStart[phase];
+    }
+}
+
+void EndProfileFrame()
+{
+    if (!profiling)
+    {
+        return;
+    }
+    for (int i = 0; i < profilePhaseCount; ++i)
+    {
+        window[i][windowIndex] = phaseElapsed[i] * 1000;
+        if (csvFile != NULL)
+        {
+            fprintf(csvFile, i == 0 ? "%.4f" : ",%.4f", window[i][windowIndex]);
+        }
+        phaseElapsed[i] = 0;
+    }
+    if (csvFile != NULL)
+    {
+        for (int i = 0; i < profileCounterCount; ++i)
+        {
+            fprintf(csvFile, ",%d", counters[i]);
+        }
+        fputc('\n', csvFile);
+    }
+    windowIndex = (windowIndex + 1) % PROFILE_WINDOW;
+    windowCount += windowCount < PROFILE_WINDOW;
+}
+
+ProfileStatistics GetProfileStatistics(ProfilePhase phase)
+{
+    ProfileStatistics statistics = { 0, 0, 0 };
+    if (windowCount == 0)
+    {
+        return statistics;
+    }
+    double sorted[PROFILE_WINDOW];
+    memcpy(sorted, window[phase], windowCount * sizeof(double));
+    qsort(sorted, windowCount, sizeof(double), CompareDoubles);
+    double total = 0;
+    for (int i = 0; i < windowCount; ++i)
+    {
+        total += sorted[i];
+    }
+    statistics.minimum = sorted[0];
+    statistics.average = total / windowCount;
+    statistics.percentile99 = sorted[(windowCount * 99 - 1) / 100];
+    return statistics;
+}
+
+const char *GetProfilePhaseName(ProfilePhase phase)
+{
+    return phaseNames[phase];
+}
+
+void SetProfileCounter(ProfileCounter counter, int value)
+{
+    counters[counter] = value;
+}
+
+int GetProfileCounter(ProfileCounter counter)
+{
+    return counters[counter];
+}
+
+const char *GetProfileCounterName(ProfileCounter counter)
+{
+    return counterNames[counter];
+}
+
+// Writes a header row of phase and counter names, then one row per frame of
+// phase milliseconds followed by counter values. Profiling stays enabled while
+// the file is open.
+bool StartProfileCsv(const char *path)
+{
+    csvFile = fopen(path, "w");
+    if (csvFile == NULL)
+    {
+        return false;
+    }
+    for (int i = 0; i < profilePhaseCount; ++i)
+    {
+        fprintf(csvFile, i == 0 ? "%s" : ",%s", phaseNames[i]);
+    }
+    for (int i = 0; i < profileCounterCount; ++i)
+    {
+        fprintf(csvFile, ",%s", counterNames[i]);
+    }
+    fputc('\n', csvFile);
+    profiling = true;
+    return true;
+}
+
+void StopProfileCsv()
+{
+    if (csvFile != NULL)
+    {
+        fclose(csvFile);
+        csvFile = NULL;
+    }
+}
+
+bool IsProfileCsvOpen()
+{
+    return csvFile != NULL;
+}
+
+static int CompareDoubles(const void *a, const void *b)
+{
+    const double left = *(const double *)a;
+    const double right = *(const double *)b;
+    return (left > right) - (left < right);
+}
@@ -0,0 +1,107 @@
+//////////////////////////////////////////////////////////////////////
+// LICENSE
+//////////////////////////////////////////////////////////////////////
+
+// MIT License
+
+// Copyright (c) 2021 Klayton Kowalski
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// https://github.com/klaytonkowalski/game-fruit-ninja
+
+
+// Per-frame timing of the main loop phases, kept over a rolling window for the
+// overlay and optionally written to a CSV file with one row per frame. Counters
+// record per-frame totals such as draw calls alongside the timings.
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+//////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////
+
+#include <stdbool.h>
+
+//////////////////////////////////////////////////////////////////////
+// ENUMERATIONS
+//////////////////////////////////////////////////////////////////////
+
+typedef enum ProfilePhase
+{
+    framePhase,
+    musicPhase,
+    particlePhase,
+    spawnPhase,
+    fruitPhase,
+    effectPhase,
+    drawStartPhase,
+    drawPlayPhase,
+    drawLosePhase,
+    profilePhaseCount
+}
+ProfilePhase;
+
+typedef enum ProfileCounter
+{
+    fruitCounter,
+    drawCallCounter,
+    effectCounter,
+    profileCounterCount
+}
+ProfileCounter;
+
+//////////////////////////////////////////////////////////////////////
+// STRUCTURES
+//////////////////////////////////////////////////////////////////////
+
+// Milliseconds per frame over the rolling window.
+typedef struct ProfileStatistics
+{
+    double minimum;
+    double average;
+    double percentile99;
+}
+ProfileStatistics;
+
+//////////////////////////////////////////////////////////////////////
+// PROPERTIES
+//////////////////////////////////////////////////////////////////////
+
+extern bool profiling;
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////
+
+double GetProfileTime();
+void BeginProfilePhase(ProfilePhase phase);
+void EndProfilePhase(ProfilePhase phase);
+void EndProfileFrame();
+ProfileStatistics GetProfileStatistics(ProfilePhase phase);
+const char *GetProfilePhaseName(ProfilePhase phase);
+void SetProfileCounter(ProfileCounter counter, int value);
+int GetProfileCounter(ProfileCounter counter);
+const char *GetProfileCounterName(ProfileCounter counter);
+bool StartProfileCsv(const char *path);
+void StopProfileCsv();
+bool IsProfileCsvOpen();
+
+#endif
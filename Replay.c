@@ -0,0 +1,227 @@
+//////////////////////////////////////////////////////////////////////
+// LICENSE
+//////////////////////////////////////////////////////////////////////
+
+// MIT License
+
+// Copyright (c) 2021 Klayton Kowalski
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// https://github.com/klaytonkowalski/game-fruit-ninja
+
+
+// Log layout, all little-endian:
+//   header   "FNRP", version u32, seed u64, fruit capacity u32,
+//            particle capacity u32, simulation rate u32
+//   steps    one flags byte per step, followed by the pointer as two f32 when
+//            the pointerFlag bit is set (the pointer is only written when it
+//            moves)
+//   trailer  endMarker byte, steps u64, score i32, fruits slashed i32,
+//            simulation hash u64
+
+//////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////
+
+#include "Replay.h"
+#include "Binary.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+//////////////////////////////////////////////////////////////////////
+// DEFINES
+//////////////////////////////////////////////////////////////////////
+
+#define REPLAY_VERSION 2
+
+//////////////////////////////////////////////////////////////////////
+// ENUMERATIONS
+//////////////////////////////////////////////////////////////////////
+
+typedef enum ReplayFlag
+{
+    pressedFlag = 1,
+    releasedFlag = 2,
+    pointerFlag = 4,
+    endMarker = 0xFF
+}
+ReplayFlag;
+
+//////////////////////////////////////////////////////////////////////
+// CONSTANTS
+//////////////////////////////////////////////////////////////////////
+
+static const char replayMagic[4] = { 'F', 'N', 'R', 'P' };
+
+//////////////////////////////////////////////////////////////////////
+// PROPERTIES
+//////////////////////////////////////////////////////////////////////
+
+static FILE *recordFile;
+static Vector2 recordPointer;
+static unsigned long long recordSteps;
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////
+
+static void WriteFloat(FILE *file, float value);
+static bool ReadFloat(FILE *file, float *value);
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTIONS
+//////////////////////////////////////////////////////////////////////
+
+// Call after InitializeSimulation, so that the log starts from a fresh
+// simulation with the seed and capacities written to the header.
+bool StartRecording(const char *path)
+{
+    recordFile = fopen(path, "wb");
+    if (recordFile == NULL)
+    {
+        return false;
+    }
+    fwrite(replayMagic, 1, sizeof(replayMagic), recordFile);
+    WriteInteger(recordFile, REPLAY_VERSION, 4);
+    WriteInteger(recordFile, simulationSeed, 8);
+    WriteInteger(recordFile, fruits.capacity, 4);
+    WriteInteger(recordFile, particleCapacity, 4);
+    WriteInteger(recordFile, simulationRate, 4);
+    recordPointer = (Vector2) { 0, 0 };
+    recordSteps = 0;
+    return true;
+}
+
+void RecordReplayStep(SimulationInput input)
+{
+    if (recordFile == NULL)
+    {
+        return;
+    }
+    const bool moved = memcmp(&input.pointer, &recordPointer, sizeof(Vector2)) != 0;
+    fputc((input.pressed ? pressedFlag : 0) | (input.released ? releasedFlag : 0) | (moved ? pointerFlag : 0), recordFile);
+    if (moved)
+    {
+        WriteFloat(recordFile, input.pointer.x);
+        WriteFloat(recordFile, input.pointer.y);
+        recordPointer = input.pointer;
+    }
+    ++recordSteps;
+}
+
+// Writes the trailer that replays are verified against.
+void StopRecording()
+{
+    if (recordFile == NULL)
+    {
+        return;
+    }
+    fputc(endMarker, recordFile);
+    WriteInteger(recordFile, recordSteps, 8);
+    WriteInteger(recordFile, (uint32_t)score, 4);
+    WriteInteger(recordFile, (uint32_t)fruitsSlashed, 4);
+    WriteInteger(recordFile, HashSimulation(), 8);
+    fclose(recordFile);
+    recordFile = NULL;
+}
+
+// Steps a fresh simulation through the log as fast as possible and checks the
+// result against the trailer. Returns zero when the session reproduced exactly.
+int RunReplay(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        printf("%s: cannot open replay\n", path);
+        return 1;
+    }
+    char magic[4];
+    uint64_t version, seed, fruitCapacity, trailParticleCapacity, rate;
+    if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) || memcmp(magic, replayMagic, sizeof(magic)) != 0 ||
+        !ReadInteger(file, &version, 4) || version != REPLAY_VERSION ||
+        !ReadInteger(file, &seed, 8) ||
+        !ReadInteger(file, &fruitCapacity, 4) ||
+        !ReadInteger(file, &trailParticleCapacity, 4) ||
+        !ReadInteger(file, &rate, 4) || rate != (uint64_t)simulationRate)
+    {
+        printf("%s: not a compatible replay\n", path);
+        fclose(file);
+        return 1;
+    }
+    fruits.capacity = fruitCapacity;
+    particleCapacity = trailParticleCapacity;
+    simulationSeed = seed;
+    simulationTicks = 0;
+    if (!InitializeSimulation())
+    {
+        printf("%s: cannot allocate the recorded capacities\n", path);
+        fclose(file);
+        return 1;
+    }
+    const clock_t startClock = clock();
+    SimulationInput input = { { 0, 0 }, false, false };
+    unsigned long long steps = 0;
+    int flags;
+    while ((flags = fgetc(file)) != EOF && flags != endMarker)
+    {
+        input.pressed = flags & pressedFlag;
+        input.released = flags & releasedFlag;
+        if ((flags & pointerFlag) && (!ReadFloat(file, &input.pointer.x) || !ReadFloat(file, &input.pointer.y)))
+        {
+            break;
+        }
+        StepSimulation(input);
+        ++steps;
+    }
+    const double seconds = (double)(clock() - startClock) / CLOCKS_PER_SEC;
+    uint64_t recordedSteps, recordedScore, recordedSlashed, recordedHash;
+    const bool complete = flags == endMarker &&
+        ReadInteger(file, &recordedSteps, 8) &&
+        ReadInteger(file, &recordedScore, 4) &&
+        ReadInteger(file, &recordedSlashed, 4) &&
+        ReadInteger(file, &recordedHash, 8);
+    fclose(file);
+    const bool matched = complete && recordedSteps == steps && (int32_t)recordedScore == score && (int32_t)recordedSlashed == fruitsSlashed && recordedHash == HashSimulation();
+    printf("%s: %s, seed %llu, %llu steps, score %d, %.3f s (%.0fx real time)\n", path, !complete ? "TRUNCATED" : matched ? "OK" : "MISMATCH", (unsigned long long)seed, steps, score, seconds, seconds > 0 ? steps * simulationStep / seconds : 0.0);
+    TerminateSimulation();
+    return matched ? 0 : 1;
+}
+
+static void WriteFloat(FILE *file, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    WriteInteger(file, bits, 4);
+}
+
+static bool ReadFloat(FILE *file, float *value)
+{
+    uint64_t bits;
+    if (!ReadInteger(file, &bits, 4))
+    {
+        return false;
+    }
+    const uint32_t narrowBits = bits;
+    memcpy(value, &narrowBits, sizeof(*value));
+    return true;
+}
@@ -0,0 +1,1153 @@
+//////////////////////////////////////////////////////////////////////
+// LICENSE
+//////////////////////////////////////////////////////////////////////
+
+// MIT License
+
+// Copyright (c) 2021 Klayton Kowalski
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// https://github.com/klaytonkowalski/game-fruit-ninja
+
+
+//////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////
+
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "Simulation.h"
+#include "Binary.h"
+#include "Profiler.h"
+#include "Replay.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define USE_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define USE_SSE
+#endif
+
+//////////////////////////////////////////////////////////////////////
+// DEFINES
+//////////////////////////////////////////////////////////////////////
+
+#define DEFAULT_FRUIT_CAPACITY 48
+#define DEFAULT_PARTICLE_CAPACITY 16
+#define DEFAULT_EFFECT_CAPACITY 16384
+#define EFFECT_ARRAY_COUNT 8
+#define FRUIT_LANE_COUNT 8
+#define FRUIT_POOL_CHUNK 64
+#define FRUIT_ALIGNMENT 32
+
+#if FRUIT_POOL_CHUNK % FRUIT_LANE_COUNT != 0
+#error "FRUIT_POOL_CHUNK must be a multiple of FRUIT_LANE_COUNT."
+#endif
+
+//////////////////////////////////////////////////////////////////////
+// STRUCTURES
+//////////////////////////////////////////////////////////////////////
+
+// Buckets fruit by the cell containing their center so that a slash only tests
+// fruit near the pointer. Each cell heads a doubly linked list of slots, which
+// stays valid while the packed entries are swapped around.
+typedef struct FruitGrid
+{
+    int *cellHead;
+    int columns;
+    int rows;
+    int cellSize;
+}
+FruitGrid;
+
+// Scratch space for a slash query, sized to the fruit store. Candidates are
+// gathered from the grid into flat arrays so that the capsule test can run over
+// them without branches.
+typedef struct FruitQuery
+{
+    int *candidateSlot;
+    float *candidateX;
+    float *candidateY;
+    bool *candidateHit;
+    FruitHandle *hits;
+}
+FruitQuery;
+
+// PCG32 generator state. Every session owns its sequence through an explicit
+// seed, so spawns replay identically across runs, builds and platforms.
+typedef struct RandomGenerator
+{
+    uint64_t state;
+    uint64_t increment;
+}
+RandomGenerator;
+
+//////////////////////////////////////////////////////////////////////
+// CONSTANTS
+//////////////////////////////////////////////////////////////////////
+
+static const int maximumSimulationSteps = 8;
+static const float minimumFruitThrust = 5;
+static const float maximumFruitThrust = 20;
+static const float minimumFruitStrafe = -5;
+static const float maximumFruitStrafe = 5;
+static const float minimumSpawnRate = 1;
+static const float maximumSpawnRate = 0.1;
+static const float maximumElapsed = 30;
+static const float gravity = -10.0 * targetFPS;
+static const float particleMaximumElapsed = 0.1;
+static const int juiceBurstCount = 24;
+static const float minimumJuiceSpeed = 2;
+static const float maximumJuiceSpeed = 8;
+static const float minimumJuiceLifetime = 0.3;
+static const float maximumJuiceLifetime = 0.6;
+static const float halfSeparation = 2;
+static const float halfSpin = 4;
+static const float halfLifetime = 1.5;
+static const float fullTurn = 6.28318531;
+static const uint64_t effectStream = 0x9E3779B97F4A7C15ULL;
+
+// Scores triple from apple to cherry. Spawn weights sum to 100, so they read
+// as percentages.
+const FruitDescriptor fruitDescriptors[fruitTypeCount] =
+{
+    [appleType] = { .score = 1, .spawnWeight = 50, .lethal = false },
+    [bananaType] = { .score = 3, .spawnWeight = 25, .lethal = false },
+    [cherryType] = { .score = 9, .spawnWeight = 10, .lethal = false },
+    [donutType] = { .score = 0, .spawnWeight = 15, .lethal = true }
+};
+
+//////////////////////////////////////////////////////////////////////
+// PROPERTIES
+//////////////////////////////////////////////////////////////////////
+
+GameState state;
+FruitStore fruits;
+Particle *particles;
+int particleCapacity;
+int particleTail;
+int particleCount;
+EffectStore effects;
+int score;
+int fruitsSlashed;
+float simulationAccumulator;
+unsigned long long simulationTicks;
+unsigned long long simulationSeed;
+unsigned long long simulationAllocations;
+bool slashing;
+SimulationEvents simulationEvents;
+static FruitGrid fruitGrid;
+static FruitQuery fruitQuery;
+static RandomGenerator randomGenerator;
+static RandomGenerator effectGenerator;
+static uint32_t spawnThresholds[fruitTypeCount];
+static int spawnAliases[fruitTypeCount];
+static float spawnElapsed;
+static float totalElapsed;
+static Vector2 previousMousePosition;
+static Vector2 framePointer;
+static bool pendingPressed;
+static bool pendingReleased;
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////
+
+static void ReadConfigFile(const char *path);
+static void UpdateStartState(SimulationInput input);
+static void UpdatePlayState(SimulationInput input);
+static void UpdateLoseState(SimulationInput input);
+static void FromStartToPlayState(Vector2 pointer);
+static void FromPlayToLoseState();
+static void FromLoseToStartState();
+static void SpawnFruit();
+static FruitType SampleFruitType();
+static void SlashFruit(FruitHandle handle);
+static void RemoveFruit(int index);
+static void ClearFruits();
+static bool GrowFruits();
+static int ResolveFruitHandle(FruitHandle handle);
+static bool InitializeFruitGrid();
+static int GetFruitCell(float x, float y);
+static void LinkFruitCell(int slot, int cell);
+static void UnlinkFruitCell(int slot);
+static void UpdateFruitGrid();
+static int QueryFruitGrid(Vector2 start, Vector2 end);
+static void IntegrateFruits();
+static void InitializeEffects();
+static void EmitSlashBurst(FruitType type, float x, float y, float vx, float vy);
+static void EmitEffect(EffectKind kind, FruitType type, float x, float y, float vx, float vy, float spin, float lifetime);
+static void RemoveEffect(int index);
+static void UpdateEffects();
+static void SeedRandomGenerator(RandomGenerator *generator, uint64_t seed, uint64_t stream);
+static uint32_t GetRandomBits(RandomGenerator *generator);
+static int GetRandomInteger(RandomGenerator *generator, int minimum, int maximum);
+static float GetRandomFloat(RandomGenerator *generator, float minimum, float maximum);
+static bool ResizeAlignedArray(float **array, size_t oldSize, size_t newSize);
+static bool ResizeArray(void **array, size_t size);
+static void FreeAligned(void *block);
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTIONS
+//////////////////////////////////////////////////////////////////////
+
+// Capacities come from FruitNinja.cfg (or the file given by --config), and any
+// command line options override the file. Without --seed the clock picks one.
+void ConfigureSimulation(int argc, char *argv[])
+{
+    fruits.capacity = DEFAULT_FRUIT_CAPACITY;
+    particleCapacity = DEFAULT_PARTICLE_CAPACITY;
+    effects.capacity = DEFAULT_EFFECT_CAPACITY;
+    simulationSeed = time(NULL);
+    const char *configPath = "FruitNinja.cfg";
+    for (int i = 1; i < argc - 1; ++i)
+    {
+        if (strcmp(argv[i], "--config") == 0)
+        {
+            configPath = argv[i + 1];
+        }
+    }
+    ReadConfigFile(configPath);
+    for (int i = 1; i < argc - 1; ++i)
+    {
+        if (strcmp(argv[i], "--fruit-capacity") == 0)
+        {
+            fruits.capacity = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--particle-capacity") == 0)
+        {
+            particleCapacity = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--effect-capacity") == 0)
+        {
+            effects.capacity = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0)
+        {
+            simulationSeed = strtoull(argv[++i], NULL, 10);
+        }
+    }
+    if (fruits.capacity < 1)
+    {
+        fruits.capacity = DEFAULT_FRUIT_CAPACITY;
+    }
+    if (particleCapacity < 1)
+    {
+        particleCapacity = DEFAULT_PARTICLE_CAPACITY;
+    }
+    if (effects.capacity < 0)
+    {
+        effects.capacity = DEFAULT_EFFECT_CAPACITY;
+    }
+}
+
+// Reads "key = value" lines. Missing files and unknown keys are ignored.
+static void ReadConfigFile(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return;
+    }
+    char line[128];
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        char key[64];
+        int value;
+        if (line[0] == '#' || sscanf(line, " %63[^= ] = %d", key, &value) != 2)
+        {
+            continue;
+        }
+        if (strcmp(key, "fruitCapacity") == 0)
+        {
+            fruits.capacity = value;
+        }
+        else if (strcmp(key, "particleCapacity") == 0)
+        {
+            particleCapacity = value;
+        }
+        else if (strcmp(key, "effectCapacity") == 0)
+        {
+            effects.capacity = value;
+        }
+    }
+    fclose(file);
+}
+
+// Returns false, with nothing left allocated, when the configured capacities do
+// not fit in memory. Effects are cosmetic, so they are only switched off when
+// their arena does not fit.
+bool InitializeSimulation()
+{
+    particles = calloc(particleCapacity, sizeof(Particle));
+    ++simulationAllocations;
+    if (!InitializeFruitGrid() || !GrowFruits() || particles == NULL)
+    {
+        TerminateSimulation();
+        return false;
+    }
+    int weights[fruitTypeCount];
+    for (int i = 0; i < fruitTypeCount; ++i)
+    {
+        weights[i] = fruitDescriptors[i].spawnWeight;
+    }
+    SetFruitSpawnWeights(weights);
+    InitializeEffects();
+    SeedSimulation(simulationSeed);
+    ResetSimulation();
+    return true;
+}
+
+// Restarts the random sequence. Resetting does not reseed, so consecutive
+// rounds in one session continue the same sequence. Effects draw from a second
+// stream of the same seed, so cosmetic bursts never shift the spawns.
+void SeedSimulation(unsigned long long seed)
+{
+    simulationSeed = seed;
+    SeedRandomGenerator(&randomGenerator, seed, seed);
+    SeedRandomGenerator(&effectGenerator, seed, seed ^ effectStream);
+}
+
+// Returns to the start screen with an empty playfield, as on launch.
+void ResetSimulation()
+{
+    state = startState;
+    ClearFruits();
+    particleTail = 0;
+    particleCount = 0;
+    effects.count = 0;
+    score = 0;
+    fruitsSlashed = 0;
+    spawnElapsed = 0;
+    totalElapsed = 0;
+    simulationAccumulator = 0;
+    pendingPressed = false;
+    pendingReleased = false;
+    slashing = false;
+}
+
+// Runs as many fixed steps as the frame time covers, so gameplay speed does not
+// depend on the achieved frame rate. The pointer is sampled once per frame and
+// spread evenly across the steps. Button edges apply to the first step, and are
+// held over when a frame is too short to run any.
+void UpdateSimulation(SimulationInput input, float frameTime)
+{
+    simulationEvents = (SimulationEvents) { 0 };
+    pendingPressed = pendingPressed || input.pressed;
+    pendingReleased = pendingReleased || input.released;
+    simulationAccumulator += frameTime;
+    int stepCount = simulationAccumulator / simulationStep;
+    if (stepCount > maximumSimulationSteps)
+    {
+        // Drop the backlog rather than spending ever longer frames catching up.
+        stepCount = maximumSimulationSteps;
+        simulationAccumulator = stepCount * simulationStep;
+    }
+    const Vector2 frameStart = framePointer;
+    for (int i = 1; i <= stepCount; ++i)
+    {
+        simulationAccumulator -= simulationStep;
+        const float t = (float)i / stepCount;
+        SimulationInput stepInput;
+        stepInput.pointer = (Vector2) { frameStart.x + (input.pointer.x - frameStart.x) * t, frameStart.y + (input.pointer.y - frameStart.y) * t };
+        stepInput.pressed = pendingPressed;
+        stepInput.released = pendingReleased;
+        pendingPressed = false;
+        pendingReleased = false;
+        StepSimulation(stepInput);
+    }
+    framePointer = input.pointer;
+}
+
+// Advances exactly one fixed step. Everything the simulation does follows from
+// the seed and the inputs passed here, which is what replays record.
+void StepSimulation(SimulationInput input)
+{
+    RecordReplayStep(input);
+    ++simulationTicks;
+    if (state == startState)
+    {
+        UpdateStartState(input);
+    }
+    else if (state == playState)
+    {
+        UpdatePlayState(input);
+    }
+    else if (state == loseState)
+    {
+        UpdateLoseState(input);
+    }
+    BeginProfilePhase(effectPhase);
+    UpdateEffects();
+    EndProfilePhase(effectPhase);
+}
+
+// FNV-1a over everything that affects future steps, so two runs can be
+// compared bit for bit.
+unsigned long long HashSimulation()
+{
+    uint64_t hash = HASH_OFFSET_BASIS;
+    hash = HashBytes(hash, &state, sizeof(state));
+    hash = HashBytes(hash, &score, sizeof(score));
+    hash = HashBytes(hash, &fruitsSlashed, sizeof(fruitsSlashed));
+    hash = HashBytes(hash, &simulationTicks, sizeof(simulationTicks));
+    hash = HashBytes(hash, &randomGenerator, sizeof(randomGenerator));
+    hash = HashBytes(hash, &spawnElapsed, sizeof(spawnElapsed));
+    hash = HashBytes(hash, &totalElapsed, sizeof(totalElapsed));
+    hash = HashBytes(hash, &slashing, sizeof(slashing));
+    hash = HashBytes(hash, &fruits.count, sizeof(fruits.count));
+    hash = HashBytes(hash, fruits.x, fruits.count * sizeof(float));
+    hash = HashBytes(hash, fruits.y, fruits.count * sizeof(float));
+    hash = HashBytes(hash, fruits.vx, fruits.count * sizeof(float));
+    hash = HashBytes(hash, fruits.vy, fruits.count * sizeof(float));
+    hash = HashBytes(hash, fruits.type, fruits.count * sizeof(FruitType));
+    return hash;
+}
+
+void TerminateSimulation()
+{
+    FreeAligned(fruits.x);
+    FreeAligned(fruits.y);
+    FreeAligned(fruits.vx);
+    FreeAligned(fruits.vy);
+    FreeAligned(fruits.previousX);
+    FreeAligned(fruits.previousY);
+    free(fruits.type);
+    free(fruits.slot);
+    free(fruits.slotIndex);
+    free(fruits.slotGeneration);
+    free(fruits.freeSlots);
+    free(fruits.slotCell);
+    free(fruits.slotNext);
+    free(fruits.slotPrevious);
+    free(fruitGrid.cellHead);
+    free(fruitQuery.candidateSlot);
+    free(fruitQuery.candidateX);
+    free(fruitQuery.candidateY);
+    free(fruitQuery.candidateHit);
+    free(fruitQuery.hits);
+    free(particles);
+    FreeAligned(effects.arena);
+    fruits = (FruitStore) { .capacity = fruits.capacity };
+    fruitGrid = (FruitGrid) { 0 };
+    fruitQuery = (FruitQuery) { 0 };
+    particles = NULL;
+    effects = (EffectStore) { .capacity = effects.capacity };
+}
+
+static void UpdateStartState(SimulationInput input)
+{
+    if (input.pressed)
+    {
+        FromStartToPlayState(input.pointer);
+    }
+}
+
+static void UpdatePlayState(SimulationInput input)
+{
+    const Vector2 pointer = input.pointer;
+    if (input.pressed)
+    {
+        slashing = true;
+        previousMousePosition = pointer;
+    }
+    else if (input.released)
+    {
+        slashing = false;
+    }
+    totalElapsed += simulationStep;
+    spawnElapsed += simulationStep;
+    BeginProfilePhase(particlePhase);
+    // A full ring overwrites its oldest particle. Expiry only ever removes from
+    // the tail, and stops at the first particle still alive.
+    if (slashing)
+    {
+        if (particleCount == particleCapacity)
+        {
+            particleTail = (particleTail + 1) % particleCapacity;
+            --particleCount;
+        }
+        Particle *particle = &particles[(particleTail + particleCount) % particleCapacity];
+        particle->position = pointer;
+        particle->spawnTick = simulationTicks;
+        ++particleCount;
+    }
+    while (particleCount > 0 && (simulationTicks - particles[particleTail].spawnTick + 1) * simulationStep > particleMaximumElapsed)
+    {
+        particleTail = (particleTail + 1) % particleCapacity;
+        --particleCount;
+    }
+    EndProfilePhase(particlePhase);
+    BeginProfilePhase(spawnPhase);
+    const float spawnElapsedThreshold = minimumSpawnRate - totalElapsed / maximumElapsed;
+    if (spawnElapsed > (spawnElapsedThreshold < maximumSpawnRate ? maximumSpawnRate : spawnElapsedThreshold))
+    {
+        spawnElapsed = 0;
+        SpawnFruit();
+    }
+    EndProfilePhase(spawnPhase);
+    BeginProfilePhase(fruitPhase);
+    // Walk backwards so that swap-removal only moves already visited fruit.
+    for (int i = fruits.count - 1; i >= 0; --i)
+    {
+        if (fruits.y[i] > screenHeight)
+        {
+            RemoveFruit(i);
+        }
+    }
+    if (slashing)
+    {
+        // Slashing a donut clears the store, which invalidates the remaining hits.
+        const int hitCount = QueryFruitGrid(previousMousePosition, pointer);
+        for (int i = 0; i < hitCount; ++i)
+        {
+            SlashFruit(fruitQuery.hits[i]);
+        }
+    }
+    previousMousePosition = pointer;
+    IntegrateFruits();
+    UpdateFruitGrid();
+    EndProfilePhase(fruitPhase);
+}
+
+static void UpdateLoseState(SimulationInput input)
+{
+    if (input.pressed)
+    {
+        FromLoseToStartState();
+    }
+}
+
+static void FromStartToPlayState(Vector2 pointer)
+{
+    state = playState;
+    previousMousePosition = pointer;
+}
+
+static void FromPlayToLoseState()
+{
+    state = loseState;
+    ClearFruits();
+    particleCount = 0;
+    spawnElapsed = 0;
+    totalElapsed = 0;
+    slashing = false;
+}
+
+static void FromLoseToStartState()
+{
+    state = startState;
+    fruitsSlashed = 0;
+    score = 0;
+}
+
+// Spawns up to count fruit at once, for stress and benchmark runs that hold the
+// store at a fixed size. Returns how many were spawned before the capacity.
+int SpawnFruits(int count)
+{
+    const int oldCount = fruits.count;
+    for (int i = 0; i < count && fruits.count < fruits.capacity; ++i)
+    {
+        SpawnFruit();
+    }
+    return fruits.count - oldCount;
+}
+
+// Rebuilds the alias table that SpawnFruit samples, using Vose's method, so
+// only call it when the weights change (a difficulty ramp, say). Each type gets
+// one column holding weight total / fruitTypeCount: its own share, topped up
+// from one heavier type. The arithmetic is integer, so a table comes out the
+// same on every platform and replays stay deterministic. Weights must not be
+// negative and must sum to between 1 and INT_MAX.
+bool SetFruitSpawnWeights(const int weights[fruitTypeCount])
+{
+    int64_t total = 0;
+    for (int i = 0; i < fruitTypeCount; ++i)
+    {
+        if (weights[i] < 0)
+        {
+            return false;
+        }
+        total += weights[i];
+    }
+    if (total == 0 || total > INT_MAX)
+    {
+        return false;
+    }
+    int64_t scaled[fruitTypeCount];
+    int small[fruitTypeCount];
+    int large[fruitTypeCount];
+    int smallCount = 0;
+    int largeCount = 0;
+    for (int i = 0; i < fruitTypeCount; ++i)
+    {
+        scaled[i] = (int64_t)weights[i] * fruitTypeCount;
+        if (scaled[i] < total)
+        {
+            small[smallCount++] = i;
+        }
+        else
+        {
+            large[largeCount++] = i;
+        }
+    }
+    while (smallCount > 0 && largeCount > 0)
+    {
+        const int lesser = small[--smallCount];
+        const int greater = large[--largeCount];
+        spawnThresholds[lesser] = (uint32_t)((scaled[lesser] << 32) / total);
+        spawnAliases[lesser] = greater;
+        scaled[greater] -= total - scaled[lesser];
+        if (scaled[greater] < total)
+        {
+            small[smallCount++] = greater;
+        }
+        else
+        {
+            large[largeCount++] = greater;
+        }
+    }
+    // Whatever is left fills its column exactly, give or take rounding.
+    while (largeCount > 0)
+    {
+        const int full = large[--largeCount];
+        spawnThresholds[full] = UINT32_MAX;
+        spawnAliases[full] = full;
+    }
+    while (smallCount > 0)
+    {
+        const int full = small[--smallCount];
+        spawnThresholds[full] = UINT32_MAX;
+        spawnAliases[full] = full;
+    }
+    return true;
+}
+
+static void SpawnFruit()
+{
+    if (fruits.count == fruits.capacity || (fruits.count == fruits.allocated && !GrowFruits()))
+    {
+        return;
+    }
+    const int index = fruits.count++;
+    const int slot = fruits.freeSlots[--fruits.freeSlotCount];
+    fruits.slot[index] = slot;
+    fruits.slotIndex[slot] = index;
+    ++simulationEvents.fruitsSpawned;
+    fruits.type[index] = SampleFruitType();
+    fruits.x[index] = GetRandomInteger(&randomGenerator, screenWidth * 0.25, screenWidth * 0.75);
+    fruits.y[index] = screenHeight;
+    fruits.previousX[index] = fruits.x[index];
+    fruits.previousY[index] = fruits.y[index];
+    // Thrust and strafe are tuned in pixels per 60 Hz frame.
+    fruits.vx[index] = GetRandomInteger(&randomGenerator, minimumFruitStrafe, maximumFruitStrafe) * targetFPS;
+    fruits.vy[index] = -GetRandomInteger(&randomGenerator, minimumFruitThrust, maximumFruitThrust) * targetFPS;
+    LinkFruitCell(slot, GetFruitCell(fruits.x[index] + fruitRadius, fruits.y[index] + fruitRadius));
+}
+
+// One draw picks both the column, from the high half of bits * fruitTypeCount,
+// and where in the column it lands, from the low half.
+static FruitType SampleFruitType()
+{
+    const uint64_t product = (uint64_t)GetRandomBits(&randomGenerator) * fruitTypeCount;
+    const int column = product >> 32;
+    return (uint32_t)product < spawnThresholds[column] ? column : spawnAliases[column];
+}
+
+static void SlashFruit(FruitHandle handle)
+{
+    const int index = ResolveFruitHandle(handle);
+    if (index < 0)
+    {
+        return;
+    }
+    const FruitType type = fruits.type[index];
+    const FruitDescriptor descriptor = fruitDescriptors[type];
+    EmitSlashBurst(type, fruits.x[index] + fruitRadius, fruits.y[index] + fruitRadius, fruits.vx[index], fruits.vy[index]);
+    RemoveFruit(index);
+    score += descriptor.score;
+    fruitsSlashed += !descriptor.lethal;
+    ++simulationEvents.slashed[type];
+    if (descriptor.lethal)
+    {
+        FromPlayToLoseState();
+    }
+}
+
+static void RemoveFruit(int index)
+{
+    const int slot = fruits.slot[index];
+    UnlinkFruitCell(slot);
+    ++fruits.slotGeneration[slot];
+    fruits.slotIndex[slot] = -1;
+    fruits.freeSlots[fruits.freeSlotCount++] = slot;
+    const int last = --fruits.count;
+    // Removing the last fruit moves nothing, and would otherwise point the
+    // released slot back at it.
+    if (index != last)
+    {
+        fruits.x[index] = fruits.x[last];
+        fruits.y[index] = fruits.y[last];
+        fruits.vx[index] = fruits.vx[last];
+        fruits.vy[index] = fruits.vy[last];
+        fruits.previousX[index] = fruits.previousX[last];
+        fruits.previousY[index] = fruits.previousY[last];
+        fruits.type[index] = fruits.type[last];
+        fruits.slot[index] = fruits.slot[last];
+        fruits.slotIndex[fruits.slot[index]] = index;
+    }
+}
+
+static void ClearFruits()
+{
+    while (fruits.count > 0)
+    {
+        RemoveFruit(fruits.count - 1);
+    }
+}
+
+// Adds half again as many entries and slots, stopping at the capacity and then
+// rounding up to a whole chunk (so a capacity of 48 allocates 64), so that
+// filling a large store copies it only a logarithmic number of times. Existing
+// handles stay valid because the slot table keeps its numbering when it is
+// reallocated.
+static bool GrowFruits()
+{
+    const int oldCount = fruits.allocated;
+    const int growth = oldCount / 2 > FRUIT_POOL_CHUNK ? oldCount / 2 : FRUIT_POOL_CHUNK;
+    const int newCount = (oldCount + (growth < fruits.capacity - oldCount ? growth : fruits.capacity - oldCount) + FRUIT_POOL_CHUNK - 1) / FRUIT_POOL_CHUNK * FRUIT_POOL_CHUNK;
+    const size_t oldSize = oldCount * sizeof(float);
+    const size_t newSize = newCount * sizeof(float);
+    const size_t slotSize = newCount * sizeof(int);
+    if (!ResizeAlignedArray(&fruits.x, oldSize, newSize) ||
+        !ResizeAlignedArray(&fruits.y, oldSize, newSize) ||
+        !ResizeAlignedArray(&fruits.vx, oldSize, newSize) ||
+        !ResizeAlignedArray(&fruits.vy, oldSize, newSize) ||
+        !ResizeAlignedArray(&fruits.previousX, oldSize, newSize) ||
+        !ResizeAlignedArray(&fruits.previousY, oldSize, newSize) ||
+        !ResizeArray((void **)&fruits.type, newCount * sizeof(FruitType)) ||
+        !ResizeArray((void **)&fruits.slot, slotSize) ||
+        !ResizeArray((void **)&fruits.slotIndex, slotSize) ||
+        !ResizeArray((void **)&fruits.slotGeneration, newCount * sizeof(unsigned int)) ||
+        !ResizeArray((void **)&fruits.freeSlots, slotSize) ||
+        !ResizeArray((void **)&fruits.slotCell, slotSize) ||
+        !ResizeArray((void **)&fruits.slotNext, slotSize) ||
+        !ResizeArray((void **)&fruits.slotPrevious, slotSize) ||
+        !ResizeArray((void **)&fruitQuery.candidateSlot, slotSize) ||
+        !ResizeArray((void **)&fruitQuery.candidateX, newCount * sizeof(float)) ||
+        !ResizeArray((void **)&fruitQuery.candidateY, newCount * sizeof(float)) ||
+        !ResizeArray((void **)&fruitQuery.candidateHit, newCount * sizeof(bool)) ||
+        !ResizeArray((void **)&fruitQuery.hits, newCount * sizeof(FruitHandle)))
+    {
+        return false;
+    }
+    // Push the new slots so that the lowest numbered one is handed out first.
+    for (int i = newCount - 1; i >= oldCount; --i)
+    {
+        fruits.slotIndex[i] = -1;
+        fruits.slotGeneration[i] = 0;
+        fruits.slotCell[i] = -1;
+        fruits.freeSlots[fruits.freeSlotCount++] = i;
+    }
+    fruits.allocated = newCount;
+    return true;
+}
+
+// Returns the packed index of the fruit, or -1 if it has been removed.
+static int ResolveFruitHandle(FruitHandle handle)
+{
+    if (handle.slot < 0 || handle.slot >= fruits.allocated || fruits.slotGeneration[handle.slot] != handle.generation)
+    {
+        return -1;
+    }
+    return fruits.slotIndex[handle.slot];
+}
+
+static bool InitializeFruitGrid()
+{
+    fruitGrid.cellSize = fruitRadius * 2;
+    fruitGrid.columns = (screenWidth + fruitGrid.cellSize - 1) / fruitGrid.cellSize;
+    fruitGrid.rows = (screenHeight + fruitGrid.cellSize - 1) / fruitGrid.cellSize;
+    fruitGrid.cellHead = malloc(fruitGrid.columns * fruitGrid.rows * sizeof(int));
+    ++simulationAllocations;
+    if (fruitGrid.cellHead == NULL)
+    {
+        return false;
+    }
+    for (int i = 0; i < fruitGrid.columns * fruitGrid.rows; ++i)
+    {
+        fruitGrid.cellHead[i] = -1;
+    }
+    return true;
+}
+
+// Fruit outside the playfield are clamped into the border cells. Clamping never
+// moves two points further apart in cells, so queries still find them.
+static int GetFruitCell(float x, float y)
+{
+    int column = x / fruitGrid.cellSize;
+    int row = y / fruitGrid.cellSize;
+    column = column < 0 ? 0 : column >= fruitGrid.columns ? fruitGrid.columns - 1 : column;
+    row = row < 0 ? 0 : row >= fruitGrid.rows ? fruitGrid.rows - 1 : row;
+    return row * fruitGrid.columns + column;
+}
+
+static void LinkFruitCell(int slot, int cell)
+{
+    const int head = fruitGrid.cellHead[cell];
+    fruits.slotCell[slot] = cell;
+    fruits.slotPrevious[slot] = -1;
+    fruits.slotNext[slot] = head;
+    if (head >= 0)
+    {
+        fruits.slotPrevious[head] = slot;
+    }
+    fruitGrid.cellHead[cell] = slot;
+}
+
+static void UnlinkFruitCell(int slot)
+{
+    const int previous = fruits.slotPrevious[slot];
+    const int next = fruits.slotNext[slot];
+    if (previous >= 0)
+    {
+        fruits.slotNext[previous] = next;
+    }
+    else
+    {
+        fruitGrid.cellHead[fruits.slotCell[slot]] = next;
+    }
+    if (next >= 0)
+    {
+        fruits.slotPrevious[next] = previous;
+    }
+    fruits.slotCell[slot] = -1;
+}
+
+// Relinks only the fruit whose center crossed into another cell this frame.
+static void UpdateFruitGrid()
+{
+    for (int i = 0; i < fruits.count; ++i)
+    {
+        const int slot = fruits.slot[i];
+        const int cell = GetFruitCell(fruits.x[i] + fruitRadius, fruits.y[i] + fruitRadius);
+        if (cell != fruits.slotCell[slot])
+        {
+            UnlinkFruitCell(slot);
+            LinkFruitCell(slot, cell);
+        }
+    }
+}
+
+// Collects handles to every fruit touched by the pointer as it moved from start
+// to end, so fast swipes cannot pass through a fruit between two frames. Only
+// cells overlapping the segment's bounds, grown by the fruit radius, are read.
+static int QueryFruitGrid(Vector2 start, Vector2 end)
+{
+    const float minimumX = (start.x < end.x ? start.x : end.x) - fruitRadius;
+    const float minimumY = (start.y < end.y ? start.y : end.y) - fruitRadius;
+    const float maximumX = (start.x > end.x ? start.x : end.x) + fruitRadius;
+    const float maximumY = (start.y > end.y ? start.y : end.y) + fruitRadius;
+    const int firstCell = GetFruitCell(minimumX, minimumY);
+    const int lastCell = GetFruitCell(maximumX, maximumY);
+    int candidateCount = 0;
+    for (int row = firstCell / fruitGrid.columns; row <= lastCell / fruitGrid.columns; ++row)
+    {
+        for (int column = firstCell % fruitGrid.columns; column <= lastCell % fruitGrid.columns; ++column)
+        {
+            for (int slot = fruitGrid.cellHead[row * fruitGrid.columns + column]; slot >= 0; slot = fruits.slotNext[slot])
+            {
+                const int index = fruits.slotIndex[slot];
+                fruitQuery.candidateSlot[candidateCount] = slot;
+                fruitQuery.candidateX[candidateCount] = fruits.x[index] + fruitRadius;
+                fruitQuery.candidateY[candidateCount] = fruits.y[index] + fruitRadius;
+                ++candidateCount;
+            }
+        }
+    }
+    // Distance from each center to the closest point on the segment. A zero
+    // length segment collapses to the original point test.
+    const float deltaX = end.x - start.x;
+    const float deltaY = end.y - start.y;
+    const float lengthSquared = deltaX * deltaX + deltaY * deltaY;
+    const float inverseLengthSquared = lengthSquared > 0 ? 1 / lengthSquared : 0;
+    const float radiusSquared = fruitRadius * fruitRadius;
+    for (int i = 0; i < candidateCount; ++i)
+    {
+        const float offsetX = fruitQuery.candidateX[i] - start.x;
+        const float offsetY = fruitQuery.candidateY[i] - start.y;
+        float t = (offsetX * deltaX + offsetY * deltaY) * inverseLengthSquared;
+        t = t < 0 ? 0 : t > 1 ? 1 : t;
+        const float distanceX = offsetX - t * deltaX;
+        const float distanceY = offsetY - t * deltaY;
+        fruitQuery.candidateHit[i] = distanceX * distanceX + distanceY * distanceY <= radiusSquared;
+    }
+    int hitCount = 0;
+    for (int i = 0; i < candidateCount; ++i)
+    {
+        if (fruitQuery.candidateHit[i])
+        {
+            const int slot = fruitQuery.candidateSlot[i];
+            fruitQuery.hits[hitCount++] = (FruitHandle) { slot, fruits.slotGeneration[slot] };
+        }
+    }
+    return hitCount;
+}
+
+// Advances the live fruit by one simulation step in a single branch-free pass,
+// keeping the previous positions for interpolated drawing. The count is rounded
+// up to a whole number of lanes; the padding slots beyond it hold stale values
+// that are overwritten on spawn.
+static void IntegrateFruits()
+{
+    const int laneCount = (fruits.count + FRUIT_LANE_COUNT - 1) / FRUIT_LANE_COUNT * FRUIT_LANE_COUNT;
+#if defined(USE_AVX)
+    const __m256 stepLane = _mm256_set1_ps(simulationStep);
+    const __m256 gravityLane = _mm256_set1_ps(gravity * simulationStep);
+    for (int i = 0; i < laneCount; i += 8)
+    {
+        const __m256 x = _mm256_load_ps(&fruits.x[i]);
+        const __m256 y = _mm256_load_ps(&fruits.y[i]);
+        const __m256 vy = _mm256_load_ps(&fruits.vy[i]);
+        _mm256_store_ps(&fruits.previousX[i], x);
+        _mm256_store_ps(&fruits.previousY[i], y);
+        _mm256_store_ps(&fruits.x[i], _mm256_add_ps(x, _mm256_mul_ps(_mm256_load_ps(&fruits.vx[i]), stepLane)));
+        _mm256_store_ps(&fruits.y[i], _mm256_add_ps(y, _mm256_mul_ps(vy, stepLane)));
+        _mm256_store_ps(&fruits.vy[i], _mm256_sub_ps(vy, gravityLane));
+    }
+#elif defined(USE_SSE)
+    const __m128 stepLane = _mm_set1_ps(simulationStep);
+    const __m128 gravityLane = _mm_set1_ps(gravity * simulationStep);
+    for (int i = 0; i < laneCount; i += 4)
+    {
+        const __m128 x = _mm_load_ps(&fruits.x[i]);
+        const __m128 y = _mm_load_ps(&fruits.y[i]);
+        const __m128 vy = _mm_load_ps(&fruits.vy[i]);
+        _mm_store_ps(&fruits.previousX[i], x);
+        _mm_store_ps(&fruits.previousY[i], y);
+        _mm_store_ps(&fruits.x[i], _mm_add_ps(x, _mm_mul_ps(_mm_load_ps(&fruits.vx[i]), stepLane)));
+        _mm_store_ps(&fruits.y[i], _mm_add_ps(y, _mm_mul_ps(vy, stepLane)));
+        _mm_store_ps(&fruits.vy[i], _mm_sub_ps(vy, gravityLane));
+    }
+#else
+    for (int i = 0; i < laneCount; ++i)
+    {
+        fruits.previousX[i] = fruits.x[i];
+        fruits.previousY[i] = fruits.y[i];
+        fruits.x[i] += fruits.vx[i] * simulationStep;
+        fruits.y[i] += fruits.vy[i] * simulationStep;
+        fruits.vy[i] -= gravity * simulationStep;
+    }
+#endif
+}
+
+// Arrays are rounded up to whole SIMD lanes so that each one starts aligned.
+static void InitializeEffects()
+{
+    const int laneCount = (effects.capacity + FRUIT_LANE_COUNT - 1) / FRUIT_LANE_COUNT * FRUIT_LANE_COUNT;
+    effects.count = 0;
+    if (!ResizeAlignedArray(&effects.arena, 0, laneCount * (EFFECT_ARRAY_COUNT * sizeof(float) + 2)))
+    {
+        effects.arena = NULL;
+        return;
+    }
+    float **arrays[EFFECT_ARRAY_COUNT] = { &effects.x, &effects.y, &effects.vx, &effects.vy, &effects.angle, &effects.spin, &effects.elapsed, &effects.lifetime };
+    for (int i = 0; i < EFFECT_ARRAY_COUNT; ++i)
+    {
+        *arrays[i] = effects.arena + i * laneCount;
+    }
+    effects.type = (unsigned char *)(effects.arena + EFFECT_ARRAY_COUNT * laneCount);
+    effects.kind = effects.type + laneCount;
+}
+
+// Splits a slashed fruit into two spinning halves that keep its momentum, and
+// sprays juice around its center. Speeds are tuned in pixels per 60 Hz frame
+// like the fruit thrust.
+static void EmitSlashBurst(FruitType type, float x, float y, float vx, float vy)
+{
+    const float separation = halfSeparation * targetFPS;
+    EmitEffect(leftHalfEffect, type, x - fruitRadius * 0.5, y, vx - separation, vy, -halfSpin, halfLifetime);
+    EmitEffect(rightHalfEffect, type, x + fruitRadius * 0.5, y, vx + separation, vy, halfSpin, halfLifetime);
+    for (int i = 0; i < juiceBurstCount; ++i)
+    {
+        const float direction = GetRandomFloat(&effectGenerator, 0, fullTurn);
+        const float speed = GetRandomFloat(&effectGenerator, minimumJuiceSpeed, maximumJuiceSpeed) * targetFPS;
+        const float lifetime = GetRandomFloat(&effectGenerator, minimumJuiceLifetime, maximumJuiceLifetime);
+        EmitEffect(juiceEffect, type, x, y, vx * 0.5 + cosf(direction) * speed, vy * 0.5 + sinf(direction) * speed, 0, lifetime);
+    }
+}
+
+static void EmitEffect(EffectKind kind, FruitType type, float x, float y, float vx, float vy, float spin, float lifetime)
+{
+    if (effects.arena == NULL || effects.count == effects.capacity)
+    {
+        return;
+    }
+    const int index = effects.count++;
+    effects.x[index] = x;
+    effects.y[index] = y;
+    effects.vx[index] = vx;
+    effects.vy[index] = vy;
+    effects.angle[index] = 0;
+    effects.spin[index] = spin;
+    effects.elapsed[index] = 0;
+    effects.lifetime[index] = lifetime;
+    effects.type[index] = type;
+    effects.kind[index] = kind;
+}
+
+static void RemoveEffect(int index)
+{
+    const int last = --effects.count;
+    effects.x[index] = effects.x[last];
+    effects.y[index] = effects.y[last];
+    effects.vx[index] = effects.vx[last];
+    effects.vy[index] = effects.vy[last];
+    effects.angle[index] = effects.angle[last];
+    effects.spin[index] = effects.spin[last];
+    effects.elapsed[index] = effects.elapsed[last];
+    effects.lifetime[index] = effects.lifetime[last];
+    effects.type[index] = effects.type[last];
+    effects.kind[index] = effects.kind[last];
+}
+
+// Effects keep moving in every state, so the burst from a donut plays out over
+// the lose screen. The integration pass has no branches and vectorizes; expired
+// and fallen particles are then swap-removed walking backwards.
+static void UpdateEffects()
+{
+    for (int i = 0; i < effects.count; ++i)
+    {
+        effects.x[i] += effects.vx[i] * simulationStep;
+        effects.y[i] += effects.vy[i] * simulationStep;
+        effects.vy[i] -= gravity * simulationStep;
+        effects.angle[i] += effects.spin[i] * simulationStep;
+        effects.elapsed[i] += simulationStep;
+    }
+    for (int i = effects.count - 1; i >= 0; --i)
+    {
+        if (effects.elapsed[i] > effects.lifetime[i] || effects.y[i] > screenHeight + fruitRadius)
+        {
+            RemoveEffect(i);
+        }
+    }
+}
+
+// PCG32 seeding for a given seed and stream, as in pcg32_srandom.
+static void SeedRandomGenerator(RandomGenerator *generator, uint64_t seed, uint64_t stream)
+{
+    generator->state = 0;
+    generator->increment = (stream << 1) | 1;
+    GetRandomBits(generator);
+    generator->state += seed;
+    GetRandomBits(generator);
+}
+
+static uint32_t GetRandomBits(RandomGenerator *generator)
+{
+    const uint64_t state = generator->state;
+    generator->state = state * 6364136223846793005ULL + generator->increment;
+    const uint32_t shifted = ((state >> 18) ^ state) >> 27;
+    const uint32_t rotation = state >> 59;
+    return (shifted >> rotation) | (shifted << ((-rotation) & 31));
+}
+
+// Inclusive on both ends like raylib's GetRandomValue. Scaling by
+// multiplication avoids the division in a modulo.
+static int GetRandomInteger(RandomGenerator *generator, int minimum, int maximum)
+{
+    const uint64_t range = (uint64_t)(maximum - minimum) + 1;
+    return minimum + (int)((GetRandomBits(generator) * range) >> 32);
+}
+
+// Uses the top 24 bits, which a float holds exactly, so the result stays below
+// the maximum.
+static float GetRandomFloat(RandomGenerator *generator, float minimum, float maximum)
+{
+    return minimum + (maximum - minimum) * ((GetRandomBits(generator) >> 8) * (1.0f / 16777216));
+}
+
+// Moves the old contents into a new block aligned for the widest SIMD loads.
+// The rest of the block is zeroed, because SIMD loops read the padding lanes
+// past the count and uninitialized floats there can be NaNs or denormals.
+static bool ResizeAlignedArray(float **array, size_t oldSize, size_t newSize)
+{
+    void *resized = NULL;
+#if defined(_WIN32)
+    resized = _aligned_malloc(newSize, FRUIT_ALIGNMENT);
+#else
+    if (posix_memalign(&resized, FRUIT_ALIGNMENT, newSize) != 0)
+    {
+        resized = NULL;
+    }
+#endif
+    if (resized == NULL)
+    {
+        return false;
+    }
+    ++simulationAllocations;
+    size_t keptSize = 0;
+    if (*array != NULL)
+    {
+        keptSize = oldSize < newSize ? oldSize : newSize;
+        memcpy(resized, *array, keptSize);
+        FreeAligned(*array);
+    }
+    memset((char *)resized + keptSize, 0, newSize - keptSize);
+    *array = resized;
+    return true;
+}
+
+static bool ResizeArray(void **array, size_t size)
+{
+    void *resized = realloc(*array, size);
+    if (resized == NULL)
+    {
+        return false;
+    }
+    ++simulationAllocations;
+    *array = resized;
+    return true;
+}
+
+static void FreeAligned(void *block)
+{
+#if defined(_WIN32)
+    _aligned_free(block);
+#else
+    free(block);
+#endif
+}
+
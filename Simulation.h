@@ -0,0 +1,236 @@
+//////////////////////////////////////////////////////////////////////
+// LICENSE
+//////////////////////////////////////////////////////////////////////
+
+// MIT License
+
+// Copyright (c) 2021 Klayton Kowalski
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// https://github.com/klaytonkowalski/game-fruit-ninja
+
+
+// Game rules and physics with no dependency on raylib, so that sessions can
+// run without a window, GPU or audio device. The front end feeds in pointer
+// input and frame time, then reads the state below to draw and play sounds.
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+//////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////
+
+#include <stdbool.h>
+
+//////////////////////////////////////////////////////////////////////
+// ENUMERATIONS
+//////////////////////////////////////////////////////////////////////
+
+typedef enum GameState
+{
+    startState,
+    playState,
+    loseState
+}
+GameState;
+
+typedef enum FruitType
+{
+    appleType,
+    bananaType,
+    cherryType,
+    donutType,
+    fruitTypeCount
+}
+FruitType;
+
+typedef enum EffectKind
+{
+    juiceEffect,
+    leftHalfEffect,
+    rightHalfEffect
+}
+EffectKind;
+
+//////////////////////////////////////////////////////////////////////
+// STRUCTURES
+//////////////////////////////////////////////////////////////////////
+
+// Same layout as raylib's Vector2, which skips its own definition when
+// RL_VECTOR2_TYPE is already defined.
+#if !defined(RL_VECTOR2_TYPE)
+typedef struct Vector2
+{
+    float x;
+    float y;
+}
+Vector2;
+#define RL_VECTOR2_TYPE
+#endif
+
+// Refers to a fruit independently of where it currently lives in the store.
+// The generation changes whenever the slot is released, so a stale handle
+// never resolves to a fruit that has since been spawned into the same slot.
+typedef struct FruitHandle
+{
+    int slot;
+    unsigned int generation;
+}
+FruitHandle;
+
+// Fruit are stored as a structure of arrays so that the integration kernel can
+// advance several fruit per instruction without gathering fields. Live fruit
+// are packed into the first count entries; removal swaps the last fruit down.
+// The arrays grow in chunks up to capacity. Handles index the slot table, which
+// maps to the packed entry, so growing or compacting never invalidates them.
+typedef struct FruitStore
+{
+    float *x;
+    float *y;
+    float *vx;
+    float *vy;
+    float *previousX;
+    float *previousY;
+    FruitType *type;
+    int *slot;
+    int *slotIndex;
+    unsigned int *slotGeneration;
+    int *slotCell;
+    int *slotNext;
+    int *slotPrevious;
+    int *freeSlots;
+    int freeSlotCount;
+    int count;
+    int allocated;
+    int capacity;
+}
+FruitStore;
+
+// Particles share one lifetime and are emitted in order, so the live ones form
+// a contiguous run of the ring: particles[(particleTail + i) % particleCapacity]
+// for i < particleCount, oldest first.
+typedef struct Particle
+{
+    Vector2 position;
+    unsigned long long spawnTick;
+}
+Particle;
+
+// Burst particles thrown out by slashed fruit: juice droplets and the two fruit
+// halves, positioned by their centers. Every array is carved from one arena
+// allocated at startup, so bursts never allocate, and new particles are dropped
+// while the arena is full.
+typedef struct EffectStore
+{
+    float *x;
+    float *y;
+    float *vx;
+    float *vy;
+    float *angle;
+    float *spin;
+    float *elapsed;
+    float *lifetime;
+    unsigned char *type;
+    unsigned char *kind;
+    float *arena;
+    int count;
+    int capacity;
+}
+EffectStore;
+
+// Pointer state for one frame or simulation step, in playfield pixels.
+typedef struct SimulationInput
+{
+    Vector2 pointer;
+    bool pressed;
+    bool released;
+}
+SimulationInput;
+
+// Counts of what happened during the last UpdateSimulation call, so that the
+// front end can play the matching sounds.
+typedef struct SimulationEvents
+{
+    int fruitsSpawned;
+    int slashed[fruitTypeCount];
+}
+SimulationEvents;
+
+// Everything the simulation needs to know about a fruit type. spawnWeight is
+// the starting weight, which SetFruitSpawnWeights can change. Slashing a lethal
+// type ends the round. Adding a type takes an enumerator, a row in
+// fruitDescriptors and a row in the front end's fruitAppearances.
+typedef struct FruitDescriptor
+{
+    int score;
+    int spawnWeight;
+    bool lethal;
+}
+FruitDescriptor;
+
+//////////////////////////////////////////////////////////////////////
+// CONSTANTS
+//////////////////////////////////////////////////////////////////////
+
+static const int screenWidth = 960;
+static const int screenHeight = 540;
+static const int targetFPS = 60;
+static const int simulationRate = 120;
+static const int fruitRadius = 32;
+static const float simulationStep = 1.0 / simulationRate;
+
+//////////////////////////////////////////////////////////////////////
+// PROPERTIES
+//////////////////////////////////////////////////////////////////////
+
+extern GameState state;
+extern FruitStore fruits;
+extern Particle *particles;
+extern int particleCapacity;
+extern int particleTail;
+extern int particleCount;
+extern EffectStore effects;
+extern int score;
+extern int fruitsSlashed;
+extern float simulationAccumulator;
+extern unsigned long long simulationTicks;
+extern unsigned long long simulationSeed;
+extern unsigned long long simulationAllocations;
+extern bool slashing;
+extern SimulationEvents simulationEvents;
+extern const FruitDescriptor fruitDescriptors[fruitTypeCount];
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////
+
+void ConfigureSimulation(int argc, char *argv[]);
+bool InitializeSimulation();
+void SeedSimulation(unsigned long long seed);
+void ResetSimulation();
+void UpdateSimulation(SimulationInput input, float frameTime);
+void StepSimulation(SimulationInput input);
+int SpawnFruits(int count);
+bool SetFruitSpawnWeights(const int weights[fruitTypeCount]);
+unsigned long long HashSimulation();
+void TerminateSimulation();
+
+#endif
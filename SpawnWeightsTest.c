@@ -0,0 +1,129 @@
+//////////////////////////////////////////////////////////////////////
+// LICENSE
+//////////////////////////////////////////////////////////////////////
+
+// MIT License
+
+// Copyright (c) 2021 Klayton Kowalski
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// https://github.com/klaytonkowalski/game-fruit-ninja
+
+
+// Checks that spawned fruit types follow their spawn weights, through the
+// public simulation calls: the descriptor weights, weights set with
+// SetFruitSpawnWeights (including zero weights, which must never spawn), and
+// rejected weights, which must leave the previous table in place. Exits with 1
+// on any failure.
+
+//////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////
+
+#include "Simulation.h"
+
+#include <math.h>
+#include <stdio.h>
+
+//////////////////////////////////////////////////////////////////////
+// CONSTANTS
+//////////////////////////////////////////////////////////////////////
+
+static const int sampleCount = 200000;
+static const double tolerance = 0.01;
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////
+
+static bool CheckSpawnFrequencies(const char *name, const int weights[fruitTypeCount]);
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTIONS
+//////////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[])
+{
+    ConfigureSimulation(argc, argv);
+    fruits.capacity = sampleCount;
+    if (!InitializeSimulation())
+    {
+        printf("cannot allocate %d fruit\n", sampleCount);
+        return 1;
+    }
+    SeedSimulation(1);
+    int failures = 0;
+    int descriptorWeights[fruitTypeCount];
+    for (int i = 0; i < fruitTypeCount; ++i)
+    {
+        descriptorWeights[i] = fruitDescriptors[i].spawnWeight;
+    }
+    failures += !CheckSpawnFrequencies("descriptor weights", descriptorWeights);
+    int skewedWeights[fruitTypeCount] = { 0 };
+    skewedWeights[0] = 1;
+    skewedWeights[fruitTypeCount - 1] = 3;
+    if (!SetFruitSpawnWeights(skewedWeights))
+    {
+        printf("skewed weights: rejected\n");
+        ++failures;
+    }
+    failures += !CheckSpawnFrequencies("skewed weights", skewedWeights);
+    const int zeroWeights[fruitTypeCount] = { 0 };
+    int negativeWeights[fruitTypeCount] = { 0 };
+    negativeWeights[0] = -1;
+    negativeWeights[1] = 2;
+    if (SetFruitSpawnWeights(zeroWeights) || SetFruitSpawnWeights(negativeWeights))
+    {
+        printf("invalid weights: accepted\n");
+        ++failures;
+    }
+    failures += !CheckSpawnFrequencies("after rejected weights", skewedWeights);
+    TerminateSimulation();
+    printf("failures: %d\n", failures);
+    return failures > 0;
+}
+
+// Fills the store and compares how often each type spawned with its share of
+// the total weight. Types with no weight must not appear at all.
+static bool CheckSpawnFrequencies(const char *name, const int weights[fruitTypeCount])
+{
+    ResetSimulation();
+    SpawnFruits(sampleCount);
+    int counts[fruitTypeCount] = { 0 };
+    for (int i = 0; i < fruits.count; ++i)
+    {
+        ++counts[fruits.type[i]];
+    }
+    int total = 0;
+    for (int i = 0; i < fruitTypeCount; ++i)
+    {
+        total += weights[i];
+    }
+    bool passed = fruits.count == sampleCount;
+    for (int i = 0; i < fruitTypeCount; ++i)
+    {
+        const double expected = (double)weights[i] / total;
+        const double actual = (double)counts[i] / fruits.count;
+        const bool typePassed = weights[i] == 0 ? counts[i] == 0 : fabs(actual - expected) <= tolerance;
+        printf("%s: type %d expected %.4f, spawned %.4f%s\n", name, i, expected, actual, typePassed ? "" : " FAILED");
+        passed = passed && typePassed;
+    }
+    return passed;
+}
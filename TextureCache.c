@@ -0,0 +1,159 @@
+//////////////////////////////////////////////////////////////////////
+// LICENSE
+//////////////////////////////////////////////////////////////////////
+
+// MIT License
+
+// Copyright (c) 2021 Klayton Kowalski
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// https://github.com/klaytonkowalski/game-fruit-ninja
+
+
+// Cache layout, all little-endian:
+//   header  "FNTC", version u32, source hash u64, width u32, height u32
+//   pixels  width * height R8G8B8A8 pixels, row by row
+
+//////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////
+
+#include "TextureCache.h"
+#include "Binary.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+//////////////////////////////////////////////////////////////////////
+// DEFINES
+//////////////////////////////////////////////////////////////////////
+
+#define CACHE_VERSION 1
+#define CACHE_PATH_SIZE 512
+
+//////////////////////////////////////////////////////////////////////
+// CONSTANTS
+//////////////////////////////////////////////////////////////////////
+
+static const char cacheMagic[4] = { 'F', 'N', 'T', 'C' };
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////
+
+static bool ReadCache(const char *cachePath, uint64_t hash, Image *image);
+static void WriteCache(const char *cachePath, uint64_t hash, Image image);
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTIONS
+//////////////////////////////////////////////////////////////////////
+
+// Loads the image at path, whose encoded bytes may already be in memory (such
+// as an archive entry). Otherwise the file is read once and the same bytes are
+// hashed and, on a cache miss, decoded. Cached images are always R8G8B8A8.
+Image LoadCachedImage(const char *path, const unsigned char *data, int size)
+{
+    unsigned char *fileData = NULL;
+    if (data == NULL)
+    {
+        fileData = LoadFileData(path, &size);
+        data = fileData;
+    }
+    Image image = { 0 };
+    char cachePath[CACHE_PATH_SIZE];
+    if (data != NULL && snprintf(cachePath, sizeof(cachePath), "%s.texcache", path) < (int)sizeof(cachePath))
+    {
+        const uint64_t hash = HashBytes(HASH_OFFSET_BASIS, data, size);
+        if (!ReadCache(cachePath, hash, &image))
+        {
+            image = LoadImageFromMemory(GetFileExtension(path), data, size);
+            if (image.data != NULL)
+            {
+                ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+                WriteCache(cachePath, hash, image);
+            }
+        }
+    }
+    else if (data != NULL)
+    {
+        image = LoadImageFromMemory(GetFileExtension(path), data, size);
+    }
+    UnloadFileData(fileData);
+    return image;
+}
+
+static bool ReadCache(const char *cachePath, uint64_t hash, Image *image)
+{
+    FILE *file = fopen(cachePath, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    char magic[sizeof(cacheMagic)];
+    uint64_t version, cachedHash, width, height;
+    bool valid = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, cacheMagic, sizeof(magic)) == 0 &&
+        ReadInteger(file, &version, 4) && version == CACHE_VERSION &&
+        ReadInteger(file, &cachedHash, 8) && cachedHash == hash &&
+        ReadInteger(file, &width, 4) && width > 0 && width <= 16384 &&
+        ReadInteger(file, &height, 4) && height > 0 && height <= 16384;
+    if (valid)
+    {
+        const size_t pixelSize = width * height * 4;
+        void *pixels = MemAlloc(pixelSize);
+        valid = pixels != NULL && fread(pixels, 1, pixelSize, file) == pixelSize;
+        if (valid)
+        {
+            *image = (Image) { pixels, width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+        }
+        else
+        {
+            MemFree(pixels);
+        }
+    }
+    fclose(file);
+    return valid;
+}
+
+// Writes to a temporary file first, so an interrupted write never leaves a
+// cache file that looks valid.
+static void WriteCache(const char *cachePath, uint64_t hash, Image image)
+{
+    char temporaryPath[CACHE_PATH_SIZE + 4];
+    snprintf(temporaryPath, sizeof(temporaryPath), "%s.tmp", cachePath);
+    FILE *file = fopen(temporaryPath, "wb");
+    if (file == NULL)
+    {
+        return;
+    }
+    fwrite(cacheMagic, 1, sizeof(cacheMagic), file);
+    WriteInteger(file, CACHE_VERSION, 4);
+    WriteInteger(file, hash, 8);
+    WriteInteger(file, image.width, 4);
+    WriteInteger(file, image.height, 4);
+    fwrite(image.data, 4, (size_t)image.width * image.height, file);
+    const bool written = ferror(file) == 0;
+    fclose(file);
+    remove(cachePath);
+    if (!written || rename(temporaryPath, cachePath) != 0)
+    {
+        remove(temporaryPath);
+    }
+}
@@ -0,0 +1,203 @@
+//////////////////////////////////////////////////////////////////////
+// LICENSE
+//////////////////////////////////////////////////////////////////////
+
+// MIT License
+
+// Copyright (c) 2021 Klayton Kowalski
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// https://github.com/klaytonkowalski/game-fruit-ninja
+
+
+//////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////
+
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "Thread.h"
+
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////
+// STRUCTURES
+//////////////////////////////////////////////////////////////////////
+
+// The platform entry points have their own signatures, so every thread starts
+// in a trampoline that calls the real function.
+typedef struct ThreadStart
+{
+    ThreadFunction function;
+    void *argument;
+}
+ThreadStart;
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////
+
+#if defined(_WIN32)
+static DWORD WINAPI RunThread(LPVOID start);
+#else
+static void *RunThread(void *start);
+#endif
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTIONS
+//////////////////////////////////////////////////////////////////////
+
+bool StartThread(Thread *thread, ThreadFunction function, void *argument)
+{
+    thread->handle = NULL;
+    ThreadStart *start = malloc(sizeof(ThreadStart));
+    if (start == NULL)
+    {
+        return false;
+    }
+    start->function = function;
+    start->argument = argument;
+#if defined(_WIN32)
+    thread->handle = CreateThread(NULL, 0, RunThread, start, 0, NULL);
+#else
+    pthread_t *handle = malloc(sizeof(pthread_t));
+    if (handle != NULL && pthread_create(handle, NULL, RunThread, start) == 0)
+    {
+        thread->handle = handle;
+    }
+    else
+    {
+        free(handle);
+    }
+#endif
+    if (thread->handle == NULL)
+    {
+        free(start);
+        return false;
+    }
+    return true;
+}
+
+// Waits for the thread to finish. Joining a thread that never started does
+// nothing.
+void JoinThread(Thread *thread)
+{
+    if (thread->handle == NULL)
+    {
+        return;
+    }
+#if defined(_WIN32)
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+#else
+    pthread_join(*(pthread_t *)thread->handle, NULL);
+    free(thread->handle);
+#endif
+    thread->handle = NULL;
+}
+
+void SleepThread(int milliseconds)
+{
+#if defined(_WIN32)
+    Sleep(milliseconds);
+#else
+    const struct timespec duration = { milliseconds / 1000, (milliseconds % 1000) * 1000000L };
+    nanosleep(&duration, NULL);
+#endif
+}
+
+bool InitializeMutex(Mutex *mutex)
+{
+#if defined(_WIN32)
+    CRITICAL_SECTION *handle = malloc(sizeof(CRITICAL_SECTION));
+    if (handle != NULL)
+    {
+        InitializeCriticalSection(handle);
+    }
+#else
+    pthread_mutex_t *handle = malloc(sizeof(pthread_mutex_t));
+    if (handle != NULL && pthread_mutex_init(handle, NULL) != 0)
+    {
+        free(handle);
+        handle = NULL;
+    }
+#endif
+    mutex->handle = handle;
+    return handle != NULL;
+}
+
+void LockMutex(Mutex *mutex)
+{
+#if defined(_WIN32)
+    EnterCriticalSection(mutex->handle);
+#else
+    pthread_mutex_lock(mutex->handle);
+#endif
+}
+
+void UnlockMutex(Mutex *mutex)
+{
+#if defined(_WIN32)
+    LeaveCriticalSection(mutex->handle);
+#else
+    pthread_mutex_unlock(mutex->handle);
+#endif
+}
+
+void TerminateMutex(Mutex *mutex)
+{
+    if (mutex->handle == NULL)
+    {
+        return;
+    }
+#if defined(_WIN32)
+    DeleteCriticalSection(mutex->handle);
+#else
+    pthread_mutex_destroy(mutex->handle);
+#endif
+    free(mutex->handle);
+    mutex->handle = NULL;
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI RunThread(LPVOID start)
+#else
+static void *RunThread(void *start)
+#endif
+{
+    const ThreadStart threadStart = *(ThreadStart *)start;
+    free(start);
+    threadStart.function(threadStart.argument);
+#if defined(_WIN32)
+    return 0;
+#else
+    return NULL;
+#endif
+}
@@ -0,0 +1,74 @@
+//////////////////////////////////////////////////////////////////////
+// LICENSE
+//////////////////////////////////////////////////////////////////////
+
+// MIT License
+
+// Copyright (c) 2021 Klayton Kowalski
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// https://github.com/klaytonkowalski/game-fruit-ninja
+
+
+// Minimal threads and mutexes over Win32 and pthreads, so the front end can move
+// blocking work such as asset decoding and music streaming off the frame thread.
+
+#ifndef THREAD_H
+#define THREAD_H
+
+//////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////
+
+#include <stdbool.h>
+
+//////////////////////////////////////////////////////////////////////
+// STRUCTURES
+//////////////////////////////////////////////////////////////////////
+
+// Both hold a heap-allocated platform object, which keeps windows.h out of
+// files that include raylib.h.
+typedef struct Thread
+{
+    void *handle;
+}
+Thread;
+
+typedef struct Mutex
+{
+    void *handle;
+}
+Mutex;
+
+typedef void (*ThreadFunction)(void *argument);
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////
+
+bool StartThread(Thread *thread, ThreadFunction function, void *argument);
+void JoinThread(Thread *thread);
+void SleepThread(int milliseconds);
+bool InitializeMutex(Mutex *mutex);
+void LockMutex(Mutex *mutex);
+void UnlockMutex(Mutex *mutex);
+void TerminateMutex(Mutex *mutex);
+
+#endif